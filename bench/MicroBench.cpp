@@ -0,0 +1,304 @@
+#include "CLI11.hpp"
+#include "json.hpp"
+
+#include "Hash.h"
+#include "tests/Diff.h"
+#include "tests/TestFile.h"
+#include "tests/TestParser.h"
+#include "tests/TestRunning.h"
+#include "toolchain/Command.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+// Convenience.
+using JSON = nlohmann::json;
+namespace fs = std::filesystem;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Options shared by every benchmark.
+struct BenchOptions {
+  std::string filter;
+  size_t repetitions{5};
+  uint64_t maxBytes{10 * 1024 * 1024};
+  size_t maxDirectives{10000};
+  size_t spawns{50};
+  fs::path scratch;
+};
+
+// One measured benchmark, every sample is the time of a single iteration.
+struct BenchResult {
+  std::string name;
+  JSON params;
+  uint64_t bytes{0};
+  std::vector<double> samplesNs;
+
+  double median() const {
+    std::vector<double> sorted(samplesNs);
+    std::sort(sorted.begin(), sorted.end());
+    size_t mid = sorted.size() / 2;
+    return sorted.size() % 2 ? sorted[mid] : (sorted[mid - 1] + sorted[mid]) / 2;
+  }
+
+  double min() const { return *std::min_element(samplesNs.begin(), samplesNs.end()); }
+
+  double mean() const {
+    double sum = 0;
+    for (double s : samplesNs)
+      sum += s;
+    return sum / samplesNs.size();
+  }
+
+  JSON toJson() const {
+    JSON json = {{"name", name},         {"params", params},   {"samples", samplesNs.size()},
+                 {"median_ns", median()}, {"min_ns", min()},    {"mean_ns", mean()},
+                 {"samples_ns", samplesNs}};
+    if (bytes != 0)
+      json["bytes_per_second"] = bytes / (median() / 1e9);
+    return json;
+  }
+};
+
+/// @brief Make a deterministic blob of printable, newline terminated lines.
+std::string makeOutput(uint64_t bytes, uint32_t seed = 415) {
+  std::mt19937 rng(seed);
+  std::uniform_int_distribution<int> chars('!', '~');
+  std::uniform_int_distribution<int> lineLength(1, 120);
+
+  std::string out;
+  out.reserve(bytes);
+  while (out.size() < bytes) {
+    int length = lineLength(rng);
+    for (int i = 0; i < length && out.size() + 1 < bytes; ++i)
+      out += static_cast<char>(chars(rng));
+    out += '\n';
+  }
+  return out;
+}
+
+/// @brief Make a testfile with the requested number of INPUT and CHECK lines,
+/// interleaved with code and block comments like a real test.
+std::string makeTestFile(size_t directives) {
+  std::string test = "/*\n * Generated benchmark test.\n */\n#include <stdio.h>\n\n";
+  for (size_t i = 0; i < directives; ++i) {
+    if (i % 2 == 0)
+      test += "// INPUT:input line " + std::to_string(i) + "\n";
+    else
+      test += "int v" + std::to_string(i) + " = " + std::to_string(i) + "; // CHECK:" +
+              std::to_string(i) + "\n";
+  }
+  test += "\nint main() { printf(\"\\\"// not a directive\\\"\"); return 0; }\n";
+  return test;
+}
+
+void writeFile(const fs::path& path, const std::string& contents) {
+  std::ofstream out(path, std::ios::binary);
+  out << contents;
+}
+
+std::string formatBytes(uint64_t bytes) {
+  if (bytes >= 1024 * 1024)
+    return std::to_string(bytes / (1024 * 1024)) + "MB";
+  return std::to_string(bytes / 1024) + "KB";
+}
+
+// Registers and runs benchmarks, collecting their results.
+class BenchRunner {
+public:
+  BenchRunner(const BenchOptions& opts) : opts(opts) {}
+
+  // Time `fn` once per repetition after a single warm-up call.
+  void run(const std::string& name, JSON params, uint64_t bytes, const std::function<void()>& fn) {
+    if (!opts.filter.empty() && name.find(opts.filter) == std::string::npos)
+      return;
+
+    BenchResult result{name, std::move(params), bytes, {}};
+    fn();
+    for (size_t i = 0; i < opts.repetitions; ++i) {
+      auto start = Clock::now();
+      fn();
+      std::chrono::duration<double, std::nano> elapsed = Clock::now() - start;
+      result.samplesNs.push_back(elapsed.count());
+    }
+
+    std::cout << "  " << std::left << std::setw(44) << name << std::right << std::fixed
+              << std::setprecision(3) << std::setw(14) << result.median() / 1e6 << " ms (min "
+              << result.min() / 1e6 << " ms)\n";
+    std::cout.flush();
+    results.push_back(std::move(result));
+  }
+
+  const std::vector<BenchResult>& getResults() const { return results; }
+
+private:
+  const BenchOptions& opts;
+  std::vector<BenchResult> results;
+};
+
+std::vector<uint64_t> outputSizes(uint64_t maxBytes) {
+  const uint64_t KB = 1024, MB = 1024 * KB;
+  std::vector<uint64_t> sizes;
+  for (uint64_t size : {10 * KB, 100 * KB, 1 * MB, 10 * MB, 100 * MB}) {
+    if (size <= maxBytes)
+      sizes.push_back(size);
+  }
+  return sizes;
+}
+
+void benchParser(BenchRunner& runner, const BenchOptions& opts) {
+  for (size_t count = 1; count <= opts.maxDirectives; count *= 10) {
+    fs::path testPath = opts.scratch / ("parser_" + std::to_string(count) + ".c");
+    writeFile(testPath, makeTestFile(count));
+
+    runner.run("TestParser/" + std::to_string(count) + "_directives", {{"directives", count}},
+               fs::file_size(testPath), [&]() {
+                 tester::TestFile test(testPath);
+                 tester::TestParser parser(&test);
+               });
+  }
+}
+
+void benchHashFile(BenchRunner& runner, const BenchOptions& opts) {
+  for (uint64_t size : outputSizes(opts.maxBytes)) {
+    fs::path path = opts.scratch / ("hash_" + std::to_string(size) + ".out");
+    writeFile(path, makeOutput(size));
+
+    runner.run("hashFile/" + formatBytes(size), {{"bytes", size}}, size, [&]() {
+      tester::Sha256::Digest digest;
+      uint64_t hashed = 0;
+      tester::hashFile(path, digest, hashed);
+    });
+    fs::remove(path);
+  }
+}
+
+void benchDiffs(BenchRunner& runner, const BenchOptions& opts) {
+  for (uint64_t size : outputSizes(opts.maxBytes)) {
+    std::string expected = makeOutput(size);
+    std::string same = expected;
+    std::string changed = expected;
+    changed[changed.size() / 2] = changed[changed.size() / 2] == 'x' ? 'y' : 'x';
+    std::optional<std::string> errorString = tester::getErrorString(expected);
+
+    std::string sizeName = formatBytes(size);
+    runner.run("compareOutput/" + sizeName + "/equal", {{"bytes", size}, {"case", "equal"}},
+               2 * size, [&]() { tester::compareOutput(same, expected, errorString); });
+    runner.run("compareOutput/" + sizeName + "/one_change",
+               {{"bytes", size}, {"case", "one_change"}}, 2 * size,
+               [&]() { tester::compareOutput(changed, expected, errorString); });
+    runner.run("renderDiff/" + sizeName + "/one_change", {{"bytes", size}, {"case", "one_change"}},
+               2 * size, [&]() {
+                 tester::renderDiff(expected, tester::indexLines(expected), changed,
+                                    tester::indexLines(changed));
+               });
+  }
+}
+
+void benchSpawn(BenchRunner& runner, const BenchOptions& opts) {
+  JSON step = {{"stepName", "true"}, {"executablePath", "/bin/true"}, {"arguments", JSON::array()}};
+  tester::Command command(step, 10);
+  tester::ExecutionInput ei("", "", "", "");
+
+  runner.run("Command::execute/bin_true_x" + std::to_string(opts.spawns),
+             {{"spawns", opts.spawns}}, 0, [&]() {
+               for (size_t i = 0; i < opts.spawns; ++i)
+                 command.execute(ei);
+             });
+}
+
+/// @brief Print the median ratio of every benchmark against a previous run.
+void compareWithBaseline(const std::vector<BenchResult>& results, const fs::path& baselinePath) {
+  std::ifstream baselineFile(baselinePath);
+  JSON baseline;
+  baselineFile >> baseline;
+
+  std::cout << "\nComparison against " << baselinePath << " (current / baseline):\n";
+  for (const BenchResult& result : results) {
+    for (const JSON& old : baseline["benchmarks"]) {
+      if (old["name"] != result.name)
+        continue;
+      double ratio = result.median() / old["median_ns"].get<double>();
+      std::cout << "  " << std::left << std::setw(44) << result.name << std::right << std::fixed
+                << std::setprecision(3) << std::setw(10) << ratio << "x\n";
+    }
+  }
+}
+
+} // end anonymous namespace
+
+int main(int argc, char** argv) {
+  CLI::App app{"CMPUT 415 tester microbenchmarks"};
+
+  BenchOptions opts;
+  std::string jsonPath, baselinePath;
+  app.add_option("--filter", opts.filter, "Only run benchmarks whose name contains this string.");
+  app.add_option("--repetitions", opts.repetitions, "Measured repetitions per benchmark.");
+  app.add_option("--max-bytes", opts.maxBytes, "Largest generated output size in bytes.");
+  app.add_option("--max-directives", opts.maxDirectives, "Largest directive count to parse.");
+  app.add_option("--spawns", opts.spawns, "Processes spawned per Command::execute sample.");
+  app.add_option("--json", jsonPath, "Write machine readable results to this file.");
+  app.add_option("--compare", baselinePath, "Compare against a previous --json result file.")
+      ->check(CLI::ExistingFile);
+  CLI11_PARSE(app, argc, argv);
+
+  if (opts.repetitions == 0) {
+    std::cerr << "At least one repetition is required.\n";
+    return 1;
+  }
+
+  // Everything generated, including the stdout files Command creates in the
+  // working directory, lives in a scratch directory we remove afterwards.
+  opts.scratch = fs::temp_directory_path() / ("tester_bench_" + std::to_string(getpid()));
+  fs::create_directories(opts.scratch);
+  fs::path originalDir = fs::current_path();
+  if (!jsonPath.empty())
+    jsonPath = fs::absolute(jsonPath);
+  if (!baselinePath.empty())
+    baselinePath = fs::absolute(baselinePath);
+  fs::current_path(opts.scratch);
+
+  BenchRunner runner(opts);
+  std::cout << "Running benchmarks (" << opts.repetitions << " repetitions, median shown):\n";
+  benchParser(runner, opts);
+  benchHashFile(runner, opts);
+  benchDiffs(runner, opts);
+  benchSpawn(runner, opts);
+
+  fs::current_path(originalDir);
+  fs::remove_all(opts.scratch);
+
+  if (!jsonPath.empty()) {
+    JSON output = {{"benchmarks", JSON::array()},
+                   {"repetitions", opts.repetitions},
+                   {"timestamp", std::time(nullptr)}};
+#ifdef DEBUG
+    output["buildType"] = "Debug";
+#else
+    output["buildType"] = "Release";
+#endif
+    for (const BenchResult& result : runner.getResults())
+      output["benchmarks"].push_back(result.toJson());
+    std::ofstream jsonFile(jsonPath);
+    jsonFile << output.dump(2) << '\n';
+  }
+
+  if (!baselinePath.empty())
+    compareWithBaseline(runner.getResults(), baselinePath);
+
+  return 0;
+}
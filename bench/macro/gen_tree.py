@@ -0,0 +1,216 @@
+"""
+Generate a synthetic test tree for end-to-end tester benchmarks.
+
+The tree contains a module of packages with nested subpackages, a stub
+"compiler" standing in for the tested executable and two configs: one for
+a normal run and one for a --grade tournament where every package is also
+a defending executable.
+"""
+
+import argparse
+import json
+import os
+import random
+import shutil
+import stat
+
+# Directive payloads up to this size are written inline, bigger ones go to files.
+MAX_INLINE_BYTES = 4096
+
+# The stub behaves like a compiler whose output is already known: it drains
+# stdin (the INPUT of the test) and prints the sidecar .gen.out file. Tests
+# with "timeout" in their name loop forever, everything else sleeps first if
+# asked to so per-test work can be simulated.
+STUB_COMPILER = """#!/bin/sh
+case "$1" in
+  *timeout*) while :; do :; done ;;
+esac
+if [ "{sleep}" != "0" ]; then sleep {sleep}; fi
+cat > /dev/null
+exec cat "${{1%.*}}.gen.out"
+"""
+
+# The same stub in Python, which also answers as a persistent worker when
+# started with --persistent_worker.
+STUB_WORKER = """#!/usr/bin/env python3
+import json, os, sys, time
+
+def compile(source):
+    if "timeout" in source:
+        while True:
+            pass
+    if {sleep}:
+        time.sleep({sleep})
+    with open(os.path.splitext(source)[0] + ".gen.out") as f:
+        return f.read()
+
+if sys.argv[1:] == ["--persistent_worker"]:
+    for line in sys.stdin:
+        request = json.loads(line)
+        reply = {{"exitCode": 0, "stdout": compile(request["arguments"][0]), "stderr": ""}}
+        print(json.dumps(reply), flush=True)
+else:
+    sys.stdin.read()
+    sys.stdout.write(compile(sys.argv[1]))
+"""
+
+# A filter step, used when a toolchain has more than one step.
+STUB_FILTER = """#!/bin/sh
+exec cat "$1"
+"""
+
+def make_lines(rng: random.Random, size: int) -> str:
+    """
+    Make `size` bytes of printable, newline separated text without a trailing newline.
+    """
+    lines = []
+    total = 0
+    while total < size:
+        length = min(rng.randint(1, 80), size - total)
+        line = "".join(rng.choice("abcdefghijklmnopqrstuvwxyz0123456789 ") for _ in range(length))
+        lines.append(line.strip() or "x")
+        total += len(lines[-1]) + 1
+    return "\n".join(lines)
+
+def write_file(path: str, contents: str):
+    with open(path, "w") as f:
+        f.write(contents)
+
+def make_executable(path: str, contents: str):
+    write_file(path, contents)
+    os.chmod(path, os.stat(path).st_mode | stat.S_IXUSR | stat.S_IXGRP | stat.S_IXOTH)
+
+def pick_kind(rng: random.Random, args, is_solution: bool) -> str:
+    """
+    Choose whether a test passes, fails or times out. The solution package only
+    holds passing tests, otherwise the grader treats it as broken.
+    """
+    if is_solution:
+        return "pass"
+    roll = rng.random()
+    if roll < args.timeout_ratio:
+        return "timeout"
+    if roll < args.timeout_ratio + args.fail_ratio:
+        return "fail"
+    return "pass"
+
+def write_test(rng: random.Random, args, directory: str, index: int, kind: str):
+    """
+    Write a single test along with its input, expected and generated outputs.
+    """
+    stem = f"{index:04d}_{kind}"
+    test_input = make_lines(rng, args.input_bytes)
+    expected = make_lines(rng, args.check_bytes)
+    generated = expected
+    if kind == "fail":
+        generated = expected[:-1] + ("x" if not expected.endswith("x") else "y") if expected else "x"
+
+    directives = []
+    if 0 < len(test_input) <= MAX_INLINE_BYTES:
+        directives += [f"// INPUT:{line}" for line in test_input.split("\n")]
+    elif test_input:
+        write_file(os.path.join(directory, stem + ".ins"), test_input)
+        directives.append(f"// INPUT_FILE:{stem}.ins")
+
+    if 0 < len(expected) <= MAX_INLINE_BYTES:
+        directives += [f"// CHECK:{line}" for line in expected.split("\n")]
+    elif expected:
+        write_file(os.path.join(directory, stem + ".exp.out"), expected)
+        directives.append(f"// CHECK_FILE:{stem}.exp.out")
+
+    body = "/* generated test */\nint main() { return 0; }\n"
+    write_file(os.path.join(directory, stem + ".test"), body + "\n".join(directives) + "\n")
+    write_file(os.path.join(directory, stem + ".gen.out"), generated)
+
+def fill_subpackages(rng, args, path: str, depth: int, is_solution: bool, counts: dict):
+    """
+    Recursively create `--subpackages` subpackages per level down to `--depth`.
+    """
+    for sub in range(args.subpackages):
+        sub_path = os.path.join(path, f"sub{sub:02d}")
+        os.makedirs(sub_path)
+        for index in range(args.tests):
+            kind = pick_kind(rng, args, is_solution)
+            counts[kind] += 1
+            write_test(rng, args, sub_path, index, kind)
+        if depth > 1:
+            fill_subpackages(rng, args, sub_path, depth - 1, is_solution, counts)
+
+def make_toolchain(args, out_dir: str) -> list:
+    steps = [{
+        "stepName": "compile",
+        "executablePath": "$EXE",
+        "arguments": ["$INPUT"],
+        "usesInStr": True,
+        "persistent": args.persistent
+    }]
+    for step in range(1, args.steps):
+        steps.append({
+            "stepName": f"filter{step}",
+            "executablePath": os.path.join(out_dir, "stubs", "filter.sh"),
+            "arguments": ["$INPUT"]
+        })
+    return steps
+
+def main():
+    parser = argparse.ArgumentParser(description="Generate a synthetic tester benchmark tree.")
+    parser.add_argument("out", help="Directory to generate into (replaced if it exists).")
+    parser.add_argument("--packages", type=int, default=4, help="Number of packages.")
+    parser.add_argument("--depth", type=int, default=1, help="Subpackage nesting depth.")
+    parser.add_argument("--subpackages", type=int, default=2, help="Subpackages per level.")
+    parser.add_argument("--tests", type=int, default=10, help="Tests per subpackage.")
+    parser.add_argument("--input-bytes", type=int, default=64, help="INPUT size per test.")
+    parser.add_argument("--check-bytes", type=int, default=64, help="CHECK size per test.")
+    parser.add_argument("--fail-ratio", type=float, default=0.1, help="Fraction of failing tests.")
+    parser.add_argument("--timeout-ratio", type=float, default=0.0,
+                        help="Fraction of tests that loop until the timeout.")
+    parser.add_argument("--steps", type=int, default=1, help="Steps per toolchain.")
+    parser.add_argument("--sleep", type=float, default=0, help="Seconds the stub sleeps per test.")
+    parser.add_argument("--persistent", action="store_true",
+                        help="Use a Python stub that runs as a persistent worker.")
+    parser.add_argument("--seed", type=int, default=415, help="Random seed.")
+    args = parser.parse_args()
+
+    out_dir = os.path.abspath(args.out)
+    if os.path.exists(out_dir):
+        shutil.rmtree(out_dir)
+    os.makedirs(os.path.join(out_dir, "stubs"))
+
+    if args.persistent:
+        compiler = os.path.join(out_dir, "stubs", "compiler.py")
+        make_executable(compiler, STUB_WORKER.format(sleep=args.sleep))
+    else:
+        compiler = os.path.join(out_dir, "stubs", "compiler.sh")
+        make_executable(compiler, STUB_COMPILER.format(sleep=args.sleep))
+    make_executable(os.path.join(out_dir, "stubs", "filter.sh"), STUB_FILTER)
+
+    rng = random.Random(args.seed)
+    counts = {"pass": 0, "fail": 0, "timeout": 0}
+    packages = [f"pkg{p:02d}" for p in range(args.packages)]
+    for package in packages:
+        package_path = os.path.join(out_dir, "testfiles", package)
+        os.makedirs(package_path)
+        fill_subpackages(rng, args, package_path, args.depth, package == packages[0], counts)
+
+    toolchains = {"stub": make_toolchain(args, out_dir)}
+    config = {
+        "testDir": os.path.join(out_dir, "testfiles"),
+        "testedExecutablePaths": {"stub": compiler},
+        "toolchains": toolchains
+    }
+    grade_config = {
+        "testDir": os.path.join(out_dir, "testfiles"),
+        "testedExecutablePaths": {package: compiler for package in packages},
+        "solutionExecutable": packages[0],
+        "toolchains": toolchains
+    }
+    write_file(os.path.join(out_dir, "config.json"), json.dumps(config, indent=2))
+    write_file(os.path.join(out_dir, "config_grade.json"), json.dumps(grade_config, indent=2))
+
+    summary = {"packages": args.packages, "tests": sum(counts.values()), **counts}
+    write_file(os.path.join(out_dir, "tree.json"), json.dumps(summary, indent=2))
+    print(f"-- Generated {summary['tests']} tests ({counts['pass']} pass, {counts['fail']} fail, "
+          f"{counts['timeout']} timeout) in {out_dir}")
+
+if __name__ == "__main__":
+    main()
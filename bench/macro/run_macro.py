@@ -0,0 +1,182 @@
+"""
+Run the tester over a tree made by gen_tree.py and report end-to-end throughput.
+
+Output is read through a pseudo terminal so every test result arrives as soon
+as the tester prints it. The time between two consecutive results is the
+latency of a test; subtracting the final step time the tester reports gives
+the overhead the tester itself adds per test.
+"""
+
+import argparse
+import json
+import os
+import pty
+import re
+import subprocess
+import tempfile
+import time
+
+ANSI_ESCAPE = re.compile(r"\x1b\[[0-9;]*m")
+RESULT_LINE = re.compile(r"\[(PASS|FAIL)\]\s+(\S+)\s*(?:([0-9.]+)\s*\(s\))?")
+GRADE_ROW = re.compile(r"^\s*\((\S+)\)\s+-->\s+\((\S+)\)\s*")
+DEFAULT_TESTER = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "..", "bin",
+                              "tester")
+
+def percentile(values, pct):
+    """
+    Nearest-rank percentile of a list, zero when the list is empty.
+    """
+    if not values:
+        return 0.0
+    ordered = sorted(values)
+    rank = max(0, min(len(ordered) - 1, int(round(pct / 100 * len(ordered))) - 1))
+    return ordered[rank]
+
+def run_with_pty(command):
+    """
+    Run `command` attached to a pseudo terminal. Returns a list of (timestamp, text)
+    chunks, the wall time and the peak RSS of the child in KB.
+    """
+    leader, follower = pty.openpty()
+    start = time.monotonic()
+    proc = subprocess.Popen(command, stdout=follower, stderr=subprocess.STDOUT, close_fds=True)
+    os.close(follower)
+
+    chunks = []
+    while True:
+        try:
+            data = os.read(leader, 65536)
+        except OSError:
+            break
+        if not data:
+            break
+        chunks.append((time.monotonic() - start, data.decode(errors="replace")))
+
+    _, status, usage = os.wait4(proc.pid, 0)
+    wall = time.monotonic() - start
+    os.close(leader)
+    return chunks, wall, usage.ru_maxrss, os.waitstatus_to_exitcode(status)
+
+def normal_latencies(chunks):
+    """
+    Pull (latency, final step time, name) for every test out of a normal run.
+    """
+    results = []
+    last = None
+    buffered = ""
+    for stamp, text in chunks:
+        buffered += ANSI_ESCAPE.sub("", text)
+        *lines, buffered = buffered.split("\n")
+        for line in lines:
+            match = RESULT_LINE.search(line)
+            if match:
+                if last is not None:
+                    results.append((stamp - last, float(match.group(3) or 0), match.group(2)))
+                last = stamp
+            elif "Entering subpackage" in line:
+                last = stamp
+    return results
+
+def grade_latencies(chunks, grades):
+    """
+    Pull (latency, final step time, name) for every cell of a grade run. Dots are
+    printed in the same order the grade JSON lists its timings. Dots printed while
+    validating tests against the solution are not cells, and invalid tests print
+    no dot.
+    """
+    timings = [timing for toolchain in grades["results"]
+                      for defense in toolchain["toolchainResults"]
+                      for attack in defense["defenderResults"]
+                      for timing in attack["timings"] if not timing.get("invalid")]
+    stamps = []
+    last = None
+    in_matrix = False
+    for stamp, text in chunks:
+        for line in ANSI_ESCAPE.sub("", text).split("\n"):
+            in_matrix = in_matrix or line.startswith("Toolchain:")
+            if not in_matrix:
+                continue
+            row = GRADE_ROW.match(line)
+            if row:
+                last = stamp
+                line = line[row.end():]
+            for _ in range(line.count(".") + line.count("x")):
+                if last is not None:
+                    stamps.append(stamp - last)
+                last = stamp
+
+    return [(latency, timing["time"], timing["test"]) for latency, timing in zip(stamps, timings)]
+
+def summarise(mode, results, wall, rss_kb, timeout):
+    """
+    Reduce per-test measurements into the numbers we track between builds. Tests
+    that timed out are excluded from the overhead figures since they are dominated
+    by the timeout itself.
+    """
+    latencies = [latency for latency, _, _ in results]
+    overheads = [max(0.0, latency - step) for latency, step, name in results
+                 if "timeout" not in name]
+    timeouts = sum(1 for _, _, name in results if "timeout" in name)
+    return {
+        "mode": mode,
+        "tests": len(results),
+        "timeouts": timeouts,
+        "wallSeconds": wall,
+        "testsPerSecond": len(results) / wall if wall > 0 else 0.0,
+        "latencyP50": percentile(latencies, 50),
+        "latencyP99": percentile(latencies, 99),
+        "overheadP50": percentile(overheads, 50),
+        "overheadP99": percentile(overheads, 99),
+        "peakRssMB": rss_kb / 1024,
+        "timeout": timeout
+    }
+
+def run_normal(args):
+    command = [args.tester, os.path.join(args.tree, "config.json"), "-t",
+               "--timeout", str(args.timeout)] + args.tester_args
+    chunks, wall, rss, _ = run_with_pty(command)
+    return summarise("normal", normal_latencies(chunks), wall, rss, args.timeout)
+
+def run_grade(args):
+    with tempfile.TemporaryDirectory() as scratch:
+        grade_json = os.path.join(scratch, "grades.json")
+        command = [args.tester, os.path.join(args.tree, "config_grade.json"),
+                   "--grade", grade_json, "--log-failures", os.path.join(scratch, "failures.txt"),
+                   "--timeout", str(args.timeout)] + args.tester_args
+        chunks, wall, rss, code = run_with_pty(command)
+        if code != 0 or not os.path.exists(grade_json):
+            raise RuntimeError("Tester failed in grade mode:\n" + "".join(t for _, t in chunks))
+        with open(grade_json) as f:
+            grades = json.load(f)
+    return summarise("grade", grade_latencies(chunks, grades), wall, rss, args.timeout)
+
+def main():
+    parser = argparse.ArgumentParser(description="End-to-end tester throughput benchmark.")
+    parser.add_argument("tree", help="Directory produced by gen_tree.py.")
+    parser.add_argument("--tester", default=DEFAULT_TESTER, help="Path to the tester binary.")
+    parser.add_argument("--mode", choices=["normal", "grade", "both"], default="both")
+    parser.add_argument("--timeout", type=int, default=1, help="Tester --timeout value.")
+    parser.add_argument("--json", help="Write the summaries to this file.")
+    parser.add_argument("tester_args", nargs="*", help="Extra arguments passed to the tester.")
+    args = parser.parse_args()
+    args.tester = os.path.abspath(args.tester)
+
+    summaries = []
+    if args.mode in ("normal", "both"):
+        summaries.append(run_normal(args))
+    if args.mode in ("grade", "both"):
+        summaries.append(run_grade(args))
+
+    for s in summaries:
+        print(f"{s['mode']:>6}: {s['tests']} tests in {s['wallSeconds']:.2f}s "
+              f"({s['testsPerSecond']:.1f} tests/s), "
+              f"latency p50 {s['latencyP50'] * 1000:.2f}ms p99 {s['latencyP99'] * 1000:.2f}ms, "
+              f"overhead p50 {s['overheadP50'] * 1000:.2f}ms p99 {s['overheadP99'] * 1000:.2f}ms, "
+              f"peak RSS {s['peakRssMB']:.1f}MB")
+
+    if args.json:
+        with open(args.json, "w") as f:
+            json.dump(summaries, f, indent=2)
+
+if __name__ == "__main__":
+    main()
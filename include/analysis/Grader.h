@@ -4,9 +4,13 @@
 #include "config/Config.h"
 #include "json.hpp"
 #include "testharness/TestHarness.h"
+#include "testharness/TestPipeline.h"
 #include "tests/TestRunning.h"
 
+#include <functional>
 #include <map>
+#include <memory>
+#include <optional>
 #include <ostream>
 #include <string>
 #include <utility>
@@ -34,6 +38,25 @@ public:
   }
 
 private:
+  // The result of running a test, kept so it can be reused. Invalid runs
+  // stand in for tests the solution fails, which are not run at all.
+  struct GradedRun {
+    bool pass;
+    bool error;
+    JSON timing;
+    bool invalid{false};
+  };
+
+  // A test of an attacker's package, with its result if that is known
+  // without running it.
+  struct PlannedTest {
+    TestFile* test;
+    std::optional<GradedRun> known;
+  };
+
+  // The tests to run for each attacker, in attackingTestPackages order.
+  typedef std::vector<std::vector<PlannedTest>> TestPlan;
+
   // Build the results to produce our sheet.
   void buildResults();
   
@@ -41,6 +64,40 @@ private:
   void trackSolutionFailure(const TestFile *test, const std::string& toolchainName,
                                                   const std::string& attackingPackage);
 
+  // Hash the contents of every test so identical tests can run once.
+  void fingerprintTests();
+
+  // The entry for a test the solution fails, which is not run.
+  static GradedRun getInvalidRun(const TestFile *test);
+
+  // Runs of a test can only be shared if the test is the same and it is run
+  // the same way: with the attacker's timing policy and on the attacker's CPUs.
+  uint64_t getRunKey(const std::string& toolChainName, const std::string& attacker,
+                     const TestFile *test) const;
+
+  // Start running a plan's tests against an executable, each distinct test
+  // without a known result once. Take the results with takeRun.
+  std::unique_ptr<TestPipeline> startPlan(const std::string& toolChainName,
+                                          const std::string& exeName, const TestPlan& plan);
+
+  // The result of the next planned test of an attacker, taking it from the
+  // pipeline if it ran. `done` holds the results of the distinct runs so far.
+  GradedRun takeRun(TestPipeline& pipeline, const std::string& toolChainName,
+                    const std::string& attacker, const PlannedTest& planned,
+                    std::map<uint64_t, GradedRun>& done);
+
+  // Run the solution over every test before the tournament, logging the tests
+  // it fails so they can be left out of the tournament.
+  void validateTests();
+
+  // How many tests there are, and how many runs the tournament has for
+  // --progress, leaving out the tests known to fail the solution.
+  size_t countTests() const;
+  size_t countTournamentRuns() const;
+
+  // Copy a toolchain and set it up to test an executable.
+  ToolChain getToolChainFor(const std::string& toolChainName, const std::string& exeName) const;
+
 private:
   std::ofstream failedTestLog;
   std::string solutionExecutable;
@@ -49,6 +106,13 @@ private:
   std::vector<std::string> defendingExes;
   std::vector<std::string> attackingTestPackages;
 
+  // The solution's results for each toolchain. Tests missing here weren't validated.
+  std::map<std::string, std::map<const TestFile*, GradedRun>> solutionRuns;
+
+  // The fingerprint of every test, and how many runs reusing them saved.
+  std::map<const TestFile*, uint64_t> fingerprints;
+  size_t dedupedRuns{0};
+
   // Tester tournament results
   JSON outputJson;
 
@@ -5,6 +5,8 @@
 
 #include <filesystem>
 #include <map>
+#include <memory>
+#include <set>
 #include <string>
 
 // Convenience.
@@ -49,11 +51,47 @@ public:
   // Config bool getters.
   bool isTimed() const { return time; }
   bool isMemoryChecked() const { return memory; }
+  bool usesPerfCounters() const { return perfCounters; }
+
+  // Whether each command's process group is killed with it.
+  bool killsProcessGroups() const { return killProcessGroups; }
   int getVerbosity() const { return verbosity; }
 
   // Config int getters.
   int64_t getTimeout() const { return timeout; }
 
+  // How many tests run at once, and how many threads judge their outputs.
+  unsigned int getJobs() const { return jobs; }
+  unsigned int getCompareJobs() const { return compareJobs; }
+
+  // Print how busy each stage of the test pipeline was.
+  bool showsPipelineStats() const { return pipelineStats; }
+
+  // Show how far the run got while it runs.
+  bool showsProgress() const { return progress; }
+
+  // Where to export Prometheus metrics: a file rewritten every interval, and
+  // a local HTTP port, 0 if none.
+  const std::optional<fs::path>& getMetricsFilePath() const { return metricsFilePath; }
+  unsigned int getMetricsPort() const { return metricsPort; }
+  unsigned int getMetricsInterval() const { return metricsInterval; }
+
+  // Timing policy for the final step of a toolchain running a package.
+  TimingPolicy getTimingPolicy(const std::string& toolChain, const std::string& package) const;
+
+  // CPUs the steps of a toolchain running a package are pinned to, if any.
+  CpuList getCpuAffinity(const std::string& toolChain, const std::string& package) const;
+  const CpuLanes& getCpuLanes() const { return cpuLanes; }
+
+  // The solution's step times and how they limit other executables' steps,
+  // if timeouts adapt or a timing history is kept.
+  const std::shared_ptr<StepTimes>& getStepTimes() const { return stepTimes; }
+  const AdaptiveTimeout& getAdaptiveTimeout() const { return adaptiveTimeout; }
+  const std::optional<fs::path>& getTimingHistoryPath() const { return timingHistoryPath; }
+
+  // Outputs of the steps toolchains share, if sharing is on.
+  const std::shared_ptr<StepCache>& getStepCache() const { return stepCache; }
+
   // Initialisation verification.
   bool isInitialised() const { return initialised; }
   int getErrorCode() const { return errorCode; }
@@ -77,11 +115,46 @@ private:
   
   // Option flags.
   bool debug, time, memory;
+  bool perfCounters{false};
+  bool killProcessGroups{false};
   int verbosity{0};
 
   // The command timeout.
   int64_t timeout;
 
+  // Pipeline sizes.
+  unsigned int jobs{1};
+  unsigned int compareJobs{0};
+  bool pipelineStats{false};
+  bool progress{false};
+
+  // Metrics exports.
+  std::optional<fs::path> metricsFilePath;
+  unsigned int metricsPort{0};
+  unsigned int metricsInterval{15};
+
+  // Statistical timing of final steps, restricted to some toolchains and
+  // packages when those are given.
+  TimingPolicy timingPolicy;
+  std::optional<std::set<std::string>> timedToolChains, timedPackages;
+
+  // Reserved cores for timed toolchains and packages.
+  CpuLanes cpuLanes;
+
+  // Outputs of step prefixes shared by toolchains.
+  std::shared_ptr<StepCache> stepCache;
+
+  // Adaptive timeouts.
+  AdaptiveTimeout adaptiveTimeout;
+  std::optional<fs::path> timingHistoryPath;
+  std::shared_ptr<StepTimes> stepTimes;
+
+  // Let toolchains share the step prefixes they have in common.
+  void planSharedSteps();
+
+  // Is the toolchain and package covered by the timing set up.
+  bool inTimingScope(const std::string& toolChain, const std::string& package) const;
+
   // Is the config initialised or not and an appropriate error code. This
   // could be due to asking for help or a missing config file.
   bool initialised;
@@ -0,0 +1,110 @@
+#ifndef TESTER_BOUNDED_QUEUE_H
+#define TESTER_BOUNDED_QUEUE_H
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+
+namespace tester {
+
+// How full a queue got and how long the stages around it waited on it.
+struct QueueStats {
+  size_t capacity{0};
+  size_t maxDepth{0};
+
+  // The depth each item found on arrival, on average.
+  double meanDepth{0};
+
+  // Time spent waiting to push into a full queue and to pop from an empty one.
+  double fullSeconds{0}, emptySeconds{0};
+};
+
+// A queue joining two pipeline stages. Pushing waits while it is full and
+// popping while it is empty, so a slow stage holds back the stages feeding it
+// instead of work piling up in between.
+template <typename T> class BoundedQueue {
+public:
+  explicit BoundedQueue(size_t capacity) : capacity(std::max<size_t>(capacity, 1)) {}
+
+  // Add an item, waiting for room. Returns false without adding it once the
+  // queue is closed.
+  bool push(T item) {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (items.size() >= capacity && !closed) {
+      auto start = Clock::now();
+      notFull.wait(lock, [this]() { return items.size() < capacity || closed; });
+      fullTime += Clock::now() - start;
+    }
+    if (closed)
+      return false;
+
+    depthSum += items.size();
+    ++pushes;
+    items.push_back(std::move(item));
+    maxDepth = std::max(maxDepth, items.size());
+    notEmpty.notify_one();
+    return true;
+  }
+
+  // Take the oldest item, waiting for one. Returns false once the queue is
+  // closed and everything in it has been taken.
+  bool pop(T& item) {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (items.empty() && !closed) {
+      auto start = Clock::now();
+      notEmpty.wait(lock, [this]() { return !items.empty() || closed; });
+      emptyTime += Clock::now() - start;
+    }
+    if (items.empty())
+      return false;
+
+    item = std::move(items.front());
+    items.pop_front();
+    notFull.notify_one();
+    return true;
+  }
+
+  // Nothing more will be pushed. What is already queued can still be taken.
+  void close() {
+    std::lock_guard<std::mutex> lock(mutex);
+    closed = true;
+    notFull.notify_all();
+    notEmpty.notify_all();
+  }
+
+  // How many items are waiting now.
+  size_t size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return items.size();
+  }
+
+  QueueStats getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    QueueStats stats;
+    stats.capacity = capacity;
+    stats.maxDepth = maxDepth;
+    stats.meanDepth = pushes == 0 ? 0 : static_cast<double>(depthSum) / pushes;
+    stats.fullSeconds = std::chrono::duration<double>(fullTime).count();
+    stats.emptySeconds = std::chrono::duration<double>(emptyTime).count();
+    return stats;
+  }
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  mutable std::mutex mutex;
+  std::condition_variable notFull, notEmpty;
+  std::deque<T> items;
+  const size_t capacity;
+  bool closed{false};
+
+  size_t maxDepth{0}, depthSum{0}, pushes{0};
+  Clock::duration fullTime{0}, emptyTime{0};
+};
+
+} // End namespace tester
+
+#endif // TESTER_BOUNDED_QUEUE_H
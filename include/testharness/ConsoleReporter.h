@@ -0,0 +1,57 @@
+#ifndef TESTER_CONSOLE_REPORTER_H
+#define TESTER_CONSOLE_REPORTER_H
+
+#include "config/Config.h"
+#include "tests/TestFile.h"
+#include "tests/TestResult.h"
+
+#include <memory>
+#include <streambuf>
+#include <string>
+
+namespace tester {
+
+// Writes the console output of a run from a thread of its own. While it
+// exists, everything written to std::cout is buffered and written out in
+// order, a few times a second at most, so a slow terminal holds up neither
+// the tests nor whoever reports them. Flushing std::cout doesn't wait.
+class ConsoleReporter {
+public:
+  // Take over std::cout.
+  explicit ConsoleReporter(const Config& cfg);
+
+  // Write what is left and give std::cout back.
+  ~ConsoleReporter();
+
+  // std::cout is taken over once, the reporter can't be copied.
+  ConsoleReporter(const ConsoleReporter&) = delete;
+  ConsoleReporter& operator=(const ConsoleReporter&) = delete;
+
+  // A test's line in the PASS/FAIL listing.
+  void testResult(const TestFile* test, const TestResult& result);
+
+  // A test's cell in the grader's matrix. Tests that pass on stdout are green
+  // dots, failures are red dots. Error tests that pass are a green 'x'.
+  void gradeResult(bool pass, bool error);
+
+  // Wait until everything reported so far is written.
+  void flush();
+
+  // Show a status line on stderr, kept below the output when both go to the
+  // terminal. An empty line takes it away. Only for terminals.
+  void setStatus(std::string line);
+
+private:
+  class Buffer;
+
+  const Config& cfg;
+
+  // std::cout's own buffer, the console.
+  std::streambuf* console;
+
+  std::unique_ptr<Buffer> buffer;
+};
+
+} // End namespace tester
+
+#endif // TESTER_CONSOLE_REPORTER_H
@@ -0,0 +1,51 @@
+#ifndef TESTER_METRICS_EXPORTER_H
+#define TESTER_METRICS_EXPORTER_H
+
+#include "config/Config.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace tester {
+
+// Exports the run's metrics for Prometheus while it runs, if the config asks
+// for it: rewriting a file every interval for a textfile collector, and
+// answering scrapes on a local HTTP port.
+class MetricsExporter {
+public:
+  // Start exporting.
+  explicit MetricsExporter(const Config& cfg);
+
+  // Write the file one last time and stop serving.
+  ~MetricsExporter();
+
+  // The threads use the exporter, it can't be copied.
+  MetricsExporter(const MetricsExporter&) = delete;
+  MetricsExporter& operator=(const MetricsExporter&) = delete;
+
+private:
+  // Write the file in one go, so a collector never reads half of it.
+  void writeFile();
+
+  // Rewrite the file every interval.
+  void writeFiles();
+
+  // Answer HTTP requests on the listening socket.
+  void serve();
+
+private:
+  const Config& cfg;
+
+  // The listening socket, -1 if not serving.
+  int listener{-1};
+
+  std::mutex mutex;
+  std::condition_variable stopCv;
+  bool stopping{false};
+  std::thread writer, server;
+};
+
+} // End namespace tester
+
+#endif // TESTER_METRICS_EXPORTER_H
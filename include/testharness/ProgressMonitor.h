@@ -0,0 +1,81 @@
+#ifndef TESTER_PROGRESS_MONITOR_H
+#define TESTER_PROGRESS_MONITOR_H
+
+#include "config/Config.h"
+#include "testharness/ConsoleReporter.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace tester {
+
+// Counts how far a run got: the cells reported out of the total, the tests
+// run and how long they took, the workers busy and the timeouts so far. With
+// --progress it shows them every so often, on a status line when stderr is a
+// terminal and as a log line on stderr otherwise.
+class ProgressMonitor {
+public:
+  // Starts showing progress if the config asks for it.
+  ProgressMonitor(const Config& cfg, ConsoleReporter& reporter);
+
+  // Stops showing progress, logging a last line when not on a terminal.
+  ~ProgressMonitor();
+
+  // The monitor's thread uses it, it can't be copied.
+  ProgressMonitor(const ProgressMonitor&) = delete;
+  ProgressMonitor& operator=(const ProgressMonitor&) = delete;
+
+  // Set how many cells are still to be reported: lines of the PASS/FAIL
+  // listing or cells of the grader's matrix.
+  void setRemaining(size_t cells);
+
+  // A cell was reported, whether its test ran or its result was reused.
+  void cellDone();
+
+  // A worker started running a test's toolchain.
+  void testStarted();
+
+  // A worker finished running a test's toolchain after `seconds`.
+  void testFinished(double seconds, bool timedOut);
+
+  // The counts as one line.
+  std::string getSummary() const;
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  // Latencies are counted in buckets 2^(1/8) apart, from a microsecond up.
+  static constexpr size_t BUCKETS = 320;
+  static constexpr double BUCKETS_PER_DOUBLING = 8;
+
+  // Shows the progress until the monitor is destroyed.
+  void show();
+
+  // The latency below which a fraction of the tests finished.
+  double getLatencyQuantile(double fraction) const;
+
+private:
+  const Config& cfg;
+  ConsoleReporter& reporter;
+  const bool onTerminal;
+  const Clock::time_point start;
+
+  std::atomic<size_t> total{0}, done{0}, ran{0}, running{0}, timeouts{0};
+  std::atomic<int64_t> latencyNanos{0};
+  std::array<std::atomic<uint64_t>, BUCKETS> latencies{};
+
+  std::mutex mutex;
+  std::condition_variable stopCv;
+  bool stopping{false};
+  std::thread thread;
+};
+
+} // End namespace tester
+
+#endif // TESTER_PROGRESS_MONITOR_H
@@ -3,6 +3,9 @@
 
 #include "Colors.h"
 #include "config/Config.h"
+#include "testharness/ConsoleReporter.h"
+#include "testharness/MetricsExporter.h"
+#include "testharness/ProgressMonitor.h"
 #include "testharness/ResultManager.h"
 #include "tests/TestParser.h"
 #include "toolchain/ToolChain.h"
@@ -28,7 +31,10 @@ public:
   TestHarness() = delete;
 
   // Construct the Tester with a parsed JSON file.
-  TestHarness(const Config& cfg) : cfg(cfg), results() { findTests(); }
+  TestHarness(const Config& cfg)
+      : cfg(cfg), reporter(cfg), progress(cfg, reporter), metrics(cfg), results() {
+    findTests();
+  }
 
   // Returns true if any tests failed, false otherwise.
   bool runTests();
@@ -49,6 +55,15 @@ protected:
   // A separate subpackage, just for invalid tests.
   SubPackage invalidTests;
 
+  // Writes std::cout for as long as the harness exists.
+  ConsoleReporter reporter;
+
+  // Counts the tests for --progress.
+  ProgressMonitor progress;
+
+  // Exports the run's metrics, if asked to.
+  MetricsExporter metrics;
+
   // let derived classes find tests.
   void findTests();
 
@@ -60,9 +75,6 @@ private:
   // test running
   bool runTestsForToolChain(std::string tcId, std::string exeName);
 
-  // helper for formatting tester output 
-  void printTestResult(const TestFile *test, TestResult result);
-
   // test finding and filling methods
   void addTestFileToSubPackage(SubPackage& subPackage, const fs::path& file);
 
@@ -0,0 +1,122 @@
+#ifndef TESTER_TEST_PIPELINE_H
+#define TESTER_TEST_PIPELINE_H
+
+#include "config/Config.h"
+#include "testharness/BoundedQueue.h"
+#include "testharness/ProgressMonitor.h"
+#include "tests/TestFile.h"
+#include "tests/TestResult.h"
+#include "toolchain/ToolChain.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Convenience.
+namespace fs = std::filesystem;
+
+namespace tester {
+
+// Tests that run with the same toolchain set up, usually a subpackage.
+struct TestGroup {
+  std::shared_ptr<ToolChain> toolChain;
+  std::vector<TestFile*> tests;
+};
+
+// A judged test, along with what judging it logged.
+struct JudgedTest {
+  TestResult result;
+  std::string log;
+};
+
+// Runs tests through stages joined by bounded queues. Discovery sets up each
+// group's toolchain and queues its tests, spawn workers run their toolchains,
+// compare workers judge the outputs and whoever takes the results reports
+// them, in the order the groups list the tests. Up to `jobs` tests run at
+// once, each writing its output files to a scratch directory of its own.
+class TestPipeline {
+public:
+  // Start running the groups' tests, counting them in `progress`.
+  TestPipeline(const Config& cfg, std::vector<TestGroup> groups, ProgressMonitor& progress);
+
+  // Stops whatever is still running and removes the scratch directories.
+  ~TestPipeline();
+
+  // The threads share the pipeline, it can't be copied.
+  TestPipeline(const TestPipeline&) = delete;
+  TestPipeline& operator=(const TestPipeline&) = delete;
+
+  // The next test's result, waiting until it is judged. Rethrows anything
+  // that went wrong running it or setting up its group.
+  JudgedTest takeResult();
+
+  // How deep the queues got and how busy each stage was, for sizing them.
+  std::string getStatistics() const;
+
+private:
+  struct Job;
+  using Clock = std::chrono::steady_clock;
+
+  // The stages.
+  void discover();
+  void spawn();
+  void compare();
+
+  // Judge a job's output, then remove its files.
+  void judge(Job& job);
+
+  // Tell the metrics how deep the queues are now.
+  void updateQueueDepths();
+
+  // Hand a finished job to the reporter.
+  void finish(std::unique_ptr<Job> job);
+
+  // Stop queueing and running tests after a failure.
+  void abort();
+
+private:
+  const Config& cfg;
+  std::vector<TestGroup> groups;
+  ProgressMonitor& progress;
+
+  // Where tests write their files when several run at once, empty otherwise.
+  fs::path scratchRoot;
+
+  // Timed tests run alone, or only alone among timed tests if they have CPUs
+  // of their own. Every other test shares runLock.
+  std::shared_mutex runLock;
+  std::mutex timedLock;
+
+  BoundedQueue<std::unique_ptr<Job>> runQueue, compareQueue;
+
+  // Judged jobs waiting for the jobs before them to be reported. Discovery
+  // stays at most `window` tests ahead of the reporter.
+  std::mutex orderMutex;
+  std::condition_variable judgedCv, reportedCv;
+  std::map<size_t, std::unique_ptr<Job>> judged;
+  size_t window, queued{0}, reported{0}, maxReorder{0};
+  bool discoveryDone{false};
+  std::exception_ptr discoveryError;
+  std::atomic_bool aborted{false};
+
+  // How long each stage was busy, and how long the reporter waited.
+  std::atomic<int64_t> discoverNanos{0}, spawnNanos{0}, compareNanos{0};
+  Clock::duration reportWait{0};
+  Clock::time_point start, end;
+
+  std::atomic<unsigned int> spawnersLeft;
+  std::vector<std::thread> threads;
+};
+
+} // End namespace tester
+
+#endif // TESTER_TEST_PIPELINE_H
@@ -0,0 +1,45 @@
+#ifndef TESTER_DIFF_H
+#define TESTER_DIFF_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace tester {
+
+// A text's lines, each line including its newline. Lines are compared by
+// hash, so comparing two lines costs the same however long they are.
+struct LineIndex {
+  // Where each line ends in the text.
+  std::vector<size_t> ends;
+
+  // FNV-1a hash of each line.
+  std::vector<uint64_t> hashes;
+};
+
+// Limits that keep diffing two very different outputs cheap.
+struct DiffOptions {
+  // Most inserted plus deleted lines searched for. Outputs further apart are
+  // only shown from where they first differ.
+  size_t maxEdits{1000};
+
+  // Most hunks shown.
+  size_t maxHunks{10};
+
+  // Unchanged lines shown around each change.
+  size_t context{3};
+};
+
+// Split a text into lines.
+LineIndex indexLines(std::string_view text);
+
+// Diff two texts line by line with Myers' algorithm and render the changes as
+// hunks: lines only expected are marked '-', lines only generated '+'.
+std::string renderDiff(std::string_view expected, const LineIndex& expectedLines,
+                       std::string_view generated, const LineIndex& generatedLines,
+                       const DiffOptions& options = DiffOptions());
+
+} // End namespace tester
+
+#endif // TESTER_DIFF_H
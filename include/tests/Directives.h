@@ -11,6 +11,10 @@ inline const std::string INPUT = "INPUT:";
 inline const std::string INPUT_FILE = "INPUT_FILE:";
 inline const std::string CHECK = "CHECK:";
 inline const std::string CHECK_FILE = "CHECK_FILE:";
+inline const std::string CHECK_HASH = "CHECK_HASH:";
+inline const std::string COMPARATOR = "COMPARATOR:";
+inline const std::string TIMEOUT = "TIMEOUT:";
+inline const std::string MEMORY = "MEMORY:";
 
 // other constants
 inline const uint32_t MAX_INPUT_BYTES = 4096;
@@ -0,0 +1,42 @@
+#ifndef TESTER_STREAM_VERDICT_H
+#define TESTER_STREAM_VERDICT_H
+
+#include "tests/TestFile.h"
+
+#include <string>
+#include <string_view>
+
+namespace tester {
+
+// Compares output to a test's expected output as it arrives, so a test can be
+// failed before the output is complete.
+class StreamVerdict {
+public:
+  // No default constructor.
+  StreamVerdict() = delete;
+
+  // Compare against this expected output, which must outlive the verdict.
+  explicit StreamVerdict(const ExpectedOutput& expected) : expected(expected) {}
+
+  // Take the next chunk of output. Returns false once the test can't pass
+  // whatever comes next.
+  bool consume(std::string_view chunk);
+
+  // Whether all the output taken is exactly the expected output.
+  bool matched() const { return !mismatched && seen == expected.contents.size(); }
+
+private:
+  const ExpectedOutput& expected;
+
+  // Bytes taken so far, and whether they stopped matching.
+  size_t seen{0};
+  bool mismatched{false};
+
+  // A mismatch still passes if the error strings of the first lines agree.
+  std::string firstLine;
+  bool firstLineDone{false};
+};
+
+} // End namespace tester
+
+#endif // TESTER_STREAM_VERDICT_H
@@ -1,10 +1,19 @@
 #ifndef TESTER_TEST_FILE_H
 #define TESTER_TEST_FILE_H
 
+#include "Hash.h"
+#include "tests/Diff.h"
+#include "toolchain/Comparator.h"
+#include "toolchain/PerfCounters.h"
+#include "toolchain/Timing.h"
+
 #include <cstring>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -16,12 +25,39 @@ enum ParseError {
   NoError,
   DirectiveConflict,
   FileError,
-  RuntimeError
+  RuntimeError,
+  InvalidDirectiveValue
 };
 
 // forward declaration
 class TestParser;
 
+// A test's expected output. It can't change while tests run, so it is read
+// once and shared by every run of the test.
+struct ExpectedOutput {
+  std::string contents;
+
+  // The contents split into hashed lines, for diffs.
+  LineIndex lines;
+
+  // FNV-1a hash of the contents.
+  uint64_t hash;
+
+  // What error tests compare, if the first line names an error.
+  std::optional<std::string> errorString;
+};
+
+// A test's expected output kept only as its digest and length, for outputs
+// too big to keep whole.
+struct ExpectedHash {
+  Sha256::Digest digest;
+  uint64_t size;
+
+  // A copy of the expected output to locate a difference in, empty if there
+  // is none at hand.
+  fs::path reference;
+};
+
 class TestFile {
 public:
   TestFile() = delete;
@@ -39,8 +75,32 @@ public:
   ParseError getParseError() const { return errorState; }
   std::string getParseErrorMsg() const;
   double getElapsedTime() const { return elapsedTime; }
+  const std::optional<TimingStats>& getTimingStats() const { return timingStats; }
+  const std::optional<PerfCounters>& getPerfCounters() const { return perfCounters; }
   bool didError() const { return errorState != ParseError::NoError; }
 
+  // The comparator the test names, null if it names none.
+  const std::shared_ptr<const Comparator>& getComparator() const { return comparator; }
+  void setComparator(std::shared_ptr<const Comparator> comparator_) {
+    comparator = std::move(comparator_);
+  }
+
+  // The time limit in seconds of each step named by a TIMEOUT directive,
+  // instead of --timeout.
+  const std::optional<double>& getTimeout() const { return timeout; }
+  void setTimeout(std::optional<double> seconds) { timeout = seconds; }
+
+  // The bytes of address space each step may use named by a MEMORY directive.
+  const std::optional<uint64_t>& getMemoryLimit() const { return memoryLimit; }
+  void setMemoryLimit(std::optional<uint64_t> bytes) { memoryLimit = bytes; }
+
+  // The digest the output must have, set by a CHECK_HASH directive.
+  const std::optional<ExpectedHash>& getExpectedHash() const { return expectedHash; }
+  void setExpectedHash(ExpectedHash hash) { expectedHash = std::move(hash); }
+
+  // The expected output, read on first use. Only call after parsing.
+  const ExpectedOutput& getExpectedOutput() const;
+
   // setters
   void setTestPath(fs::path path) { testPath = path; }
   void setInsPath(fs::path path) { insPath = path; }
@@ -48,6 +108,8 @@ public:
   void getParseError(ParseError error) { errorState = error; }
   void setParseErrorMsg(std::string msg) { errorMsg = msg; }
   void setElapsedTime(double elapsed) { elapsedTime = elapsed; }
+  void setTimingStats(std::optional<TimingStats> stats) { timingStats = std::move(stats); }
+  void setPerfCounters(std::optional<PerfCounters> counters) { perfCounters = counters; }
 
   // if test has any input and if test uses input file specifically
   bool usesInputStream{false}, usesInputFile{false}; 
@@ -68,6 +130,26 @@ private:
 
   // elapsed time for final toolchain step
   double elapsedTime{0};
+
+  // statistics over repeated runs of the final step, if it was repeated
+  std::optional<TimingStats> timingStats;
+
+  // hardware counters of the final toolchain step, if recorded
+  std::optional<PerfCounters> perfCounters;
+
+  // comparator named by a COMPARATOR directive
+  std::shared_ptr<const Comparator> comparator;
+
+  // digest of the expected output named by a CHECK_HASH directive
+  std::optional<ExpectedHash> expectedHash;
+
+  // resource limits named by TIMEOUT and MEMORY directives
+  std::optional<double> timeout;
+  std::optional<uint64_t> memoryLimit;
+
+  // expected output, loaded once by getExpectedOutput
+  mutable std::once_flag expectedLoaded;
+  mutable std::unique_ptr<const ExpectedOutput> expectedOutput;
 };
 
 } // namespace tester
@@ -26,6 +26,7 @@ private:
 
   // track state of parse
   bool foundInput{false}, foundInputFile{false}, foundCheck{false}, foundCheckFile{false};
+  bool foundCheckHash{false}, foundComparator{false}, foundTimeout{false}, foundMemory{false};
 
   // track comment state
   bool inLineComment{false}, inBlockComment{false}, inString{false};
@@ -33,12 +34,21 @@ private:
   // current input stream size
   uint32_t insByteCount{0}, outByteCount{0};
 
+  // what was wrong with a directive's value
+  std::string invalidValueMsg;
+
   // determine if we are in a comment while parsing
   void trackCommentState(std::string& line);
 
   // helper method to return the path in a FILE directive if it is good
   PathOrError parsePathFromLine(const std::string& line, const std::string& directive);
 
+  // helper method to return the value after a directive, without surrounding whitespace
+  std::string parseValueFromLine(const std::string& line, const std::string& directive);
+
+  // helper method to reject the value of a directive, saying which one and why
+  ParseError invalidValue(const std::string& directive, const std::string& reason);
+
   // helper method to insert a newline prefixed line to a file
   void insLineToFile(fs::path filePath, std::string line, bool firstInsert);
 
@@ -48,6 +58,10 @@ private:
   ParseError matchCheckDirective(std::string& line);
   ParseError matchInputFileDirective(std::string& line);
   ParseError matchCheckFileDirective(std::string& line);
+  ParseError matchCheckHashDirective(std::string& line);
+  ParseError matchComparatorDirective(std::string& line);
+  ParseError matchTimeoutDirective(std::string& line);
+  ParseError matchMemoryDirective(std::string& line);
   ParseError matchDirectives(std::string& line);
 };
 
@@ -8,19 +8,45 @@ namespace fs = std::filesystem;
 
 namespace tester {
 
+// How a generated output compared to the expected output.
+enum class OutputMatch {
+  // The toolchain failed before there was an output to compare.
+  NotCompared,
+  // Byte for byte the same.
+  Exact,
+  // Different bytes, but the same under the comparator used.
+  Equivalent,
+  // Different, but the error strings of the first lines agree.
+  ErrorLine,
+  // Different.
+  Mismatch
+};
+
+struct Comparison {
+  OutputMatch match{OutputMatch::NotCompared};
+
+  // Where a mismatching output first differs, counting from one. Zero when
+  // the comparator has no such place.
+  size_t line{0}, column{0};
+
+  bool passed() const { return match != OutputMatch::NotCompared && match != OutputMatch::Mismatch; }
+};
+
 struct TestResult {
   // No default constructor.
   TestResult() = delete;
 
   // Make the result. Extract the test file name from the path.
-  TestResult(fs::path in, bool pass, bool error, std::string diff)
-      : name(in.stem()), pass(pass), error(error), diff(diff) {}
+  TestResult(fs::path in, bool pass, bool error, std::string diff,
+             Comparison comparison = Comparison())
+      : name(in.stem()), pass(pass), error(error), diff(diff), comparison(comparison) {}
 
   // Info about result.
   const fs::path name;
   const bool pass;
   const bool error;
   const std::string diff;
+  const Comparison comparison;
 };
 
 } // End namespace tester
@@ -1,9 +1,56 @@
+#ifndef TESTER_TEST_RUNNING_H
+#define TESTER_TEST_RUNNING_H
+
+#include "Hash.h"
 #include "TestFile.h"
 #include "TestResult.h"
 #include "config/Config.h"
 
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+
 namespace tester {
 
-TestResult runTest(TestFile* test, const ToolChain& toolChain, const Config& cfg);
+// What running a test's toolchain left behind, to be judged afterwards.
+struct TestExecution {
+  ExecutionOutput output;
+
+  // Why the toolchain failed, if it did, and whether a step timed out.
+  std::optional<std::string> failure;
+  bool timedOut{false};
+
+  // The output was found to match exactly while it was written.
+  bool streamedMatch{false};
+};
+
+// Run a test's toolchain, with its output files in `scratchDir` unless it is
+// empty. The files are left for judgeTest.
+TestExecution executeTest(TestFile* test, const ToolChain& toolChain,
+                          const fs::path& scratchDir = fs::path());
+
+// Judge a test from what its toolchain left behind, writing the detail the
+// verbosity asks for to `log`.
+TestResult judgeTest(TestFile* test, const ToolChain& toolChain, const TestExecution& execution,
+                     const Config& cfg, std::ostream& log);
+
+// The part of an output's first line that error tests compare, if any.
+std::optional<std::string> getErrorString(std::string_view output);
+
+// Compare a generated output to a test's expected output with a comparator,
+// classifying it as an exact or equivalent match, an error line match or a
+// mismatch.
+Comparison compareOutput(std::string_view generated, std::string_view expected,
+                         const std::optional<std::string>& expErrorString,
+                         const Comparator& comparator = Comparator::getExact());
+Comparison compareOutput(std::string_view generated, const ExpectedOutput& expected,
+                         const Comparator& comparator = Comparator::getExact());
+
+// Hash a file a chunk at a time, as CHECK_HASH outputs are judged. Returns
+// false if the file can't be opened.
+bool hashFile(const fs::path& path, Sha256::Digest& digest, uint64_t& size);
 
 } // namespace tester
+
+#endif // TESTER_TEST_RUNNING_H
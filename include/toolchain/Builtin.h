@@ -0,0 +1,58 @@
+#ifndef TESTER_BUILTIN_H
+#define TESTER_BUILTIN_H
+
+#include <optional>
+#include <regex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace tester {
+
+// A text filter run inside the tester instead of spawning a process, named by
+// an executable path like "builtin:tail". Arguments follow the real tools.
+class Builtin {
+public:
+  // No default constructor.
+  Builtin() = delete;
+
+  // Parse the builtin and its arguments, throwing a runtime_error if either is
+  // invalid. Arguments are checked before magic parameters are resolved.
+  Builtin(const std::string& exe, const std::vector<std::string>& args);
+
+  // Whether an executable path names a builtin.
+  static bool isBuiltin(const std::string& exe);
+
+  // The index of the argument naming the input file. Without one the builtin
+  // reads stdin.
+  const std::optional<size_t>& getInputArg() const { return inputArg; }
+
+  // The number of input lines after which the rest of the input can't change
+  // the output, like for head.
+  std::optional<size_t> getLineLimit() const;
+
+  // Filter the input.
+  std::string run(std::string_view input) const;
+
+private:
+  enum class Kind { Head, Tail, StripAnsi, RegexReplace };
+
+  // Parse "-n K", "-nK" and "-n +K" (as one or two arguments) for head and tail.
+  void parseLineArgs(const std::string& exe, const std::vector<std::string>& args);
+
+private:
+  Kind kind;
+  std::optional<size_t> inputArg;
+
+  // Head and tail: how many lines, or for "tail -n +K" the line to start from.
+  size_t lines{10};
+  bool fromStart{false};
+
+  // Regex-replace: applied to every line on its own.
+  std::regex pattern;
+  std::string replacement;
+};
+
+} // End namespace tester
+
+#endif // TESTER_BUILTIN_H
@@ -5,6 +5,7 @@
 
 #include "Colors.h"
 #include "ExecutionState.h"
+#include "toolchain/Builtin.h"
 #include "toolchain/ExecutionState.h"
 
 #include <filesystem>
@@ -40,6 +41,40 @@ public:
   // Get the command name.
   std::string getName() const { return name; }
 
+  // Whether the command reads the previous command's stdout through a pipe.
+  bool isPipedFromPrevious() const { return pipeFromPrevious; }
+
+  // Whether the command's stdout is compared to the expected output as it is written.
+  bool streamsVerdict() const { return streamVerdict; }
+
+  // Run the command in a process group of its own, killing the whole group on
+  // a timeout and whatever it leaves running once it exits.
+  void setKillsProcessGroup(bool killsProcessGroup_) { killsProcessGroup = killsProcessGroup_; }
+
+  // Whether the command writes its result to a file rather than stdout.
+  bool hasOutputFile() const { return outputFile.has_value(); }
+
+  // The file the command's result ends up in, the next command's $INPUT.
+  fs::path getOutputPath(const ExecutionInput& ei) const {
+    return ei.placeOutput(outputFile.has_value() ? *outputFile : outPath);
+  }
+
+  // Whether the command only writes its output file where it is told to with
+  // $OUTPUT, so the file can be moved to a scratch directory.
+  bool isRelocatable() const;
+
+  // Everything that decides the command's output, equal for commands that
+  // produce the same output from the same input.
+  std::string getSignature() const;
+
+  // The most inputs handled by one invocation, 0 if the command isn't batched.
+  size_t getBatchSize() const { return batch; }
+
+  // Run a batched command once over many inputs, numbering their outputs from
+  // `firstIndex`. Returns nothing if the invocation failed.
+  std::vector<ExecutionOutput> executeBatch(const std::vector<ExecutionInput>& eis,
+                                            size_t firstIndex) const;
+
   // Ostream operator.
   friend std::ostream& operator<<(std::ostream&, const Command&);
 
@@ -53,6 +88,18 @@ private:
   // Resolves magic exe parameters to value.
   fs::path resolveExe(const ExecutionInput& ei, const ExecutionOutput& eo, std::string exe) const;
 
+  // The output file of the index'th input of a batch, "out.s" becomes "out.<index>.s".
+  fs::path getBatchOutputFile(size_t index) const;
+
+  // Run a builtin step inside the tester.
+  ExecutionOutput executeBuiltin(const ExecutionInput& ei, ExecutionOutput eo) const;
+
+  // Hand the step to a persistent worker. Returns nothing if there is no
+  // working worker, in which case the step runs as a process of its own.
+  std::optional<ExecutionOutput> executePersistent(const ExecutionInput& ei, ExecutionOutput eo,
+                                                   const std::vector<std::string>& trueArgs,
+                                                   const std::string& runtime) const;
+
 private:
   // Command info.
   std::string name;
@@ -73,6 +120,25 @@ private:
   // Allow return with non-zero exit code.
   bool allowError;
 
+  // Run alongside the previous command, reading its stdout as stdin.
+  bool pipeFromPrevious;
+
+  // Send the step to a persistent worker started from the executable.
+  bool persistent;
+
+  // Compare stdout to the expected output while it is written.
+  bool streamVerdict;
+
+  // Inputs per invocation when batched, and the arguments repeated per input.
+  size_t batch{0};
+  std::vector<std::string> batchArgs;
+
+  // Set when the executable is a builtin filter rather than a process.
+  std::optional<Builtin> builtin;
+
+  // Lead a process group that is killed as a whole.
+  bool killsProcessGroup{false};
+
   // Set up info.
   int64_t timeout;
 };
@@ -0,0 +1,38 @@
+#ifndef TESTER_COMPARATOR_H
+#define TESTER_COMPARATOR_H
+
+#include "tests/TestResult.h"
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace tester {
+
+// Decides whether a generated output matches the expected output, named in a
+// toolchain or test by a spec like "numeric:1e-6". Comparators look at views
+// of outputs owned elsewhere, in one pass and without allocating.
+class Comparator {
+public:
+  virtual ~Comparator() = default;
+
+  // The comparator a spec names, throwing a runtime_error if it is invalid.
+  // Specs are "exact", "ignore-trailing-whitespace", "numeric" with an
+  // optional ":<tolerance>", and "unordered-lines".
+  static std::shared_ptr<const Comparator> create(const std::string& spec);
+
+  // Byte for byte comparison, the default.
+  static const Comparator& getExact();
+
+  // Whether only identical outputs match.
+  virtual bool isExact() const { return false; }
+
+  // Compare two outputs. Matches are Exact when the bytes are the same and
+  // Equivalent otherwise. Mismatches say where they first differ, if that
+  // means anything for the comparator.
+  virtual Comparison compare(std::string_view generated, std::string_view expected) const = 0;
+};
+
+} // End namespace tester
+
+#endif // TESTER_COMPARATOR_H
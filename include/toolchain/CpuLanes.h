@@ -0,0 +1,49 @@
+#ifndef TESTER_CPU_LANES_H
+#define TESTER_CPU_LANES_H
+
+#include <string>
+#include <vector>
+
+namespace tester {
+
+// A list of logical CPU ids. An empty list means "don't pin".
+typedef std::vector<int> CpuList;
+
+// Splits the CPUs the tester may use into two lanes: a quiet lane of reserved
+// physical cores for timed tests and a shared lane for everything else. Only
+// one hardware thread of each reserved core is used, its SMT siblings are left
+// idle so timed tests don't share execution units with their neighbours.
+class CpuLanes {
+public:
+  // No lanes, nothing is pinned.
+  CpuLanes() = default;
+
+  // Reserve the given number of physical cores, picked from the highest
+  // numbered cores the tester is allowed to run on.
+  static CpuLanes reserveCores(unsigned int count);
+
+  // Reserve exactly these logical CPUs.
+  static CpuLanes reserveCpus(const CpuList& cpus);
+
+  // Are there any reserved cores.
+  bool isEnabled() const { return !timedCpus.empty(); }
+
+  // The CPUs for timed and for all other commands.
+  const CpuList& getTimedCpus() const { return timedCpus; }
+  const CpuList& getSharedCpus() const { return sharedCpus; }
+
+  // A short description, e.g. "timed [7], shared [0-2,4-6]".
+  std::string getDescription() const;
+
+private:
+  CpuList timedCpus;
+  CpuList sharedCpus;
+};
+
+// Restrict the calling process to the given CPUs. Returns false on failure or
+// when the platform does not support it. Does nothing for an empty list.
+bool pinToCpus(const CpuList& cpus);
+
+} // End namespace tester
+
+#endif // TESTER_CPU_LANES_H
@@ -1,7 +1,13 @@
 #ifndef TESTER_EXECUTION_STATE_H
 #define TESTER_EXECUTION_STATE_H
 
+#include "toolchain/CpuLanes.h"
+#include "toolchain/PerfCounters.h"
+
+#include <atomic>
+#include <cstdint>
 #include <filesystem>
+#include <memory>
 #include <optional>
 namespace fs = std::filesystem;
 
@@ -31,11 +37,60 @@ public:
   // Gets tested runtime.
   const fs::path& getTestedRuntime() const { return testedRuntime; }
 
+  // The CPUs the command is pinned to, empty if it isn't pinned.
+  const CpuList& getCpuAffinity() const { return cpuAffinity; }
+  void setCpuAffinity(CpuList cpus) { cpuAffinity = std::move(cpus); }
+
+  // Whether hardware counters are recorded for the command.
+  bool measuresCounters() const { return measureCounters; }
+  void setMeasuresCounters(bool measure) { measureCounters = measure; }
+
+  // Pipe ends a piped step uses for stdin and stdout instead of files, -1 when
+  // unused. The command takes ownership and closes them once it is started.
+  int getStdinPipe() const { return stdinPipe; }
+  int getStdoutPipe() const { return stdoutPipe; }
+  void setPipes(int stdinPipe_, int stdoutPipe_) {
+    stdinPipe = stdinPipe_;
+    stdoutPipe = stdoutPipe_;
+  }
+
+  // Set by whoever reads the command's output to stop it early, the output
+  // seen so far being enough. Null when nobody can stop it.
+  const std::shared_ptr<std::atomic_bool>& getStopFlag() const { return stopFlag; }
+  void setStopFlag(std::shared_ptr<std::atomic_bool> flag) { stopFlag = std::move(flag); }
+
+  // A directory of the test's own that the command's output files go in,
+  // keeping them apart from those of tests run at the same time. Empty to
+  // leave them where the toolchain names them.
+  const fs::path& getScratchDir() const { return scratchDir; }
+  void setScratchDir(fs::path dir) { scratchDir = std::move(dir); }
+
+  // A time limit in seconds for this run of the command, instead of the
+  // command's own.
+  const std::optional<double>& getTimeout() const { return timeout; }
+  void setTimeout(std::optional<double> seconds) { timeout = seconds; }
+
+  // The bytes of address space the command's process may use, if limited.
+  const std::optional<uint64_t>& getMemoryLimit() const { return memoryLimit; }
+  void setMemoryLimit(std::optional<uint64_t> bytes) { memoryLimit = bytes; }
+
+  // Where an output file the toolchain names `path` is written.
+  fs::path placeOutput(const fs::path& path) const {
+    return scratchDir.empty() ? path : scratchDir / path.filename();
+  }
+
 private:
   fs::path inputPath;
   fs::path inputStreamPath;
   fs::path testedExecutable;
   fs::path testedRuntime;
+  CpuList cpuAffinity;
+  bool measureCounters{false};
+  int stdinPipe{-1}, stdoutPipe{-1};
+  std::shared_ptr<std::atomic_bool> stopFlag;
+  fs::path scratchDir;
+  std::optional<double> timeout;
+  std::optional<uint64_t> memoryLimit;
 };
 
 // A class meant to share intermediate info when a toolchain step ends.
@@ -71,6 +126,14 @@ public:
   void setIsErrorTest(bool errorTest) { isErrorTest = errorTest; }
   bool IsErrorTest() const { return isErrorTest; }
 
+  // User and system CPU time of the step's process, if it had one.
+  std::optional<double> getCpuTime() const { return cpuTime; }
+  void setCpuTime(std::optional<double> time) { cpuTime = time; }
+
+  // Hardware counters, if they were asked for and available.
+  const std::optional<PerfCounters>& getPerfCounters() const { return perfCounters; }
+  void setPerfCounters(std::optional<PerfCounters> counters) { perfCounters = counters; }
+
 private:
   fs::path outPath;
   fs::path errPath;
@@ -84,6 +147,9 @@ private:
   // Flag to indicate if the generated output should be read from stdout or stderr.
   // For error tests we grab from stderr.
   bool isErrorTest;
+
+  std::optional<double> cpuTime;
+  std::optional<PerfCounters> perfCounters;
 };
 
 } // End namespace tester
@@ -0,0 +1,74 @@
+#ifndef TESTER_METRICS_H
+#define TESTER_METRICS_H
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace tester {
+
+// A distribution of durations in seconds, counted in fixed buckets the way a
+// Prometheus histogram is. Safe to observe from any thread.
+class Histogram {
+public:
+  Histogram();
+
+  void observe(double seconds);
+
+  // Write the histogram's samples as `name`, with `labels` (like
+  // `step="compile"`) added to each, in the Prometheus text format.
+  void render(std::ostream& os, const std::string& name, const std::string& labels) const;
+
+private:
+  // Upper bounds of the buckets, the last one, +Inf, left implicit.
+  static const std::vector<double> bounds;
+
+  std::unique_ptr<std::atomic<uint64_t>[]> counts;
+  std::atomic<uint64_t> count{0};
+  std::atomic<uint64_t> sumNanos{0};
+};
+
+// What the whole run did so far: tests started and how they ended, how long
+// processes took to spawn, steps to run and outputs to compare, how deep the
+// pipeline's queues are and how much memory the tester holds.
+class Metrics {
+public:
+  // The metrics shared by the whole run.
+  static Metrics& get();
+
+  void countTestStarted() { ++testsStarted; }
+  void countTestJudged(bool pass, bool timedOut);
+
+  // How long a fork took, how long a step ran and used the CPU for, and how
+  // long judging an output took.
+  void observeSpawn(double seconds) { spawn.observe(seconds); }
+  void observeStep(const std::string& step, double wallSeconds, std::optional<double> cpuSeconds);
+  void observeCompare(double seconds) { compare.observe(seconds); }
+
+  // The depths of the pipeline's run and compare queues.
+  void setQueueDepths(size_t run, size_t compare);
+
+  // Everything in the Prometheus text exposition format.
+  std::string render() const;
+
+private:
+  Metrics() = default;
+
+  std::atomic<uint64_t> testsStarted{0}, testsPassed{0}, testsFailed{0}, testsTimedOut{0};
+  std::atomic<size_t> runQueueDepth{0}, compareQueueDepth{0};
+  Histogram spawn, compare;
+
+  // Step histograms by step name.
+  mutable std::mutex stepMutex;
+  std::map<std::string, std::pair<Histogram, Histogram>> steps;
+};
+
+} // End namespace tester
+
+#endif // TESTER_METRICS_H
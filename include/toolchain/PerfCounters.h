@@ -0,0 +1,52 @@
+#ifndef TESTER_PERF_COUNTERS_H
+#define TESTER_PERF_COUNTERS_H
+
+#include <sys/types.h>
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace tester {
+
+// Hardware counter totals for a command and all of its descendants. A counter
+// the machine does not support is left empty.
+struct PerfCounters {
+  std::optional<uint64_t> instructions;
+  std::optional<uint64_t> cycles;
+  std::optional<uint64_t> branchMisses;
+  std::optional<uint64_t> cacheMisses;
+};
+
+// Owns the perf_event_open file descriptors counting a single child process.
+// Counters are armed before the child execs and start counting at the exec,
+// so the tester's own fork/exec work is never included.
+class PerfCounterGroup {
+public:
+  PerfCounterGroup() = default;
+  PerfCounterGroup(const PerfCounterGroup&) = delete;
+  PerfCounterGroup& operator=(const PerfCounterGroup&) = delete;
+  ~PerfCounterGroup();
+
+  // Attach counters to `pid`, which must not have exec'd yet. Returns false if
+  // no counter could be opened, e.g. when perf_event_paranoid forbids it.
+  bool attach(pid_t pid);
+
+  // Read the totals. Only meaningful once the child has been reaped.
+  PerfCounters read() const;
+
+  // Why the last attach failed, for reporting.
+  const std::string& getError() const { return error; }
+
+private:
+  void close();
+
+  // One descriptor per counter in PerfCounters order, -1 if unavailable.
+  std::vector<int> fds;
+  std::string error;
+};
+
+} // End namespace tester
+
+#endif // TESTER_PERF_COUNTERS_H
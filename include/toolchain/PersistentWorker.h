@@ -0,0 +1,87 @@
+#ifndef TESTER_PERSISTENT_WORKER_H
+#define TESTER_PERSISTENT_WORKER_H
+
+#include "json.hpp"
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <sys/types.h>
+#include <vector>
+
+// Convenience.
+using JSON = nlohmann::json;
+
+namespace tester {
+
+// A worker's answer to one request, standing in for the exit status and
+// standard streams of a process.
+struct WorkerResponse {
+  int exitCode{0};
+  std::string out;
+  std::string err;
+};
+
+// A tested executable started once with --persistent_worker that handles many
+// requests. Requests and responses are single lines of JSON on the worker's
+// stdin and stdout.
+class PersistentWorker {
+public:
+  enum class Status { Answered, Died, TimedOut };
+
+  // Take over a started worker, its process group and our ends of its pipes.
+  PersistentWorker(pid_t pid, int toWorker, int fromWorker)
+      : pid(pid), toWorker(toWorker), fromWorker(fromWorker) {}
+
+  // Workers are uniquely owned.
+  PersistentWorker(const PersistentWorker&) = delete;
+  PersistentWorker& operator=(const PersistentWorker&) = delete;
+
+  // Kills the worker and everything it started.
+  ~PersistentWorker();
+
+  // Send a request and wait up to `timeout` seconds for its response.
+  Status request(const JSON& request, double timeout, WorkerResponse& response);
+
+  // Whether the worker ever answered, telling a worker that crashed apart from
+  // an executable that doesn't know the protocol.
+  bool hasAnswered() const { return answered; }
+
+private:
+  pid_t pid;
+  int toWorker, fromWorker;
+
+  // Output read past the end of the previous response.
+  std::string buffered;
+  bool answered{false};
+};
+
+// Idle workers shared by every command, keyed by the executable and
+// environment they were started with.
+class WorkerPool {
+public:
+  // The pool shared by the whole run.
+  static WorkerPool& get();
+
+  // Take an idle worker, or nullptr if there are none.
+  std::unique_ptr<PersistentWorker> take(const std::string& key);
+
+  // Hand back a worker that answered its request so it can be reused.
+  void giveBack(const std::string& key, std::unique_ptr<PersistentWorker> worker);
+
+  // Stop using workers for an executable that doesn't speak the protocol.
+  // Returns false if it already was disabled.
+  bool disable(const std::string& key);
+  bool isDisabled(const std::string& key);
+
+private:
+  std::mutex mutex;
+  std::map<std::string, std::vector<std::unique_ptr<PersistentWorker>>> idle;
+  std::set<std::string> disabled;
+};
+
+} // End namespace tester
+
+#endif // TESTER_PERSISTENT_WORKER_H
@@ -0,0 +1,27 @@
+#ifndef TESTER_PIPES_H
+#define TESTER_PIPES_H
+
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace tester {
+
+// Open a pipe whose ends are closed on exec, so the only copies a command
+// keeps are the ones it dup'd onto its standard streams.
+bool openPipe(int ends[2]);
+
+// Close a pipe end if there is one, -1 meaning there isn't.
+void closePipe(int fd);
+
+// Read everything from a pipe until its writer closes it, or stop early once
+// `lineLimit` lines have arrived.
+bool readAll(int fd, std::string& contents, std::optional<size_t> lineLimit = std::nullopt);
+
+// Write everything to a pipe. Returns false if the reader went away, which
+// never kills us with SIGPIPE.
+bool writeAll(int fd, std::string_view data);
+
+} // End namespace tester
+
+#endif // TESTER_PIPES_H
@@ -0,0 +1,63 @@
+#ifndef TESTER_STEP_CACHE_H
+#define TESTER_STEP_CACHE_H
+
+#include <atomic>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Convenience.
+namespace fs = std::filesystem;
+
+namespace tester {
+
+// Copies of the outputs of step prefixes several toolchains have in common,
+// so each prefix runs once per executable and test. Outputs are kept for the
+// whole run, since the grader runs each executable once per toolchain.
+class StepCache {
+public:
+  // The elapsed time of each group of steps in a prefix, by its last step.
+  using StepTimings = std::vector<std::pair<size_t, double>>;
+
+  StepCache() = default;
+
+  // Removes the kept outputs.
+  ~StepCache();
+
+  // The cache is shared, not copied.
+  StepCache(const StepCache&) = delete;
+  StepCache& operator=(const StepCache&) = delete;
+
+  // Restore a prefix's output to where the step would have written it, and
+  // the times its steps took. Returns false if the prefix hasn't run yet for
+  // this executable.
+  bool restore(const std::string& exe, const std::string& key, const fs::path& output,
+               StepTimings& timings);
+
+  // Keep a copy of a prefix's output and the times its steps took.
+  void store(const std::string& exe, const std::string& key, const fs::path& output,
+             const StepTimings& timings);
+
+  // How many prefixes didn't have to run again.
+  size_t getHits() const { return hits; }
+
+private:
+  struct Entry {
+    fs::path copy;
+    StepTimings timings;
+  };
+
+  std::mutex mutex;
+  fs::path dir;
+
+  // Copies by executable and prefix key.
+  std::map<std::pair<std::string, std::string>, Entry> entries;
+  std::atomic<size_t> hits{0};
+};
+
+} // End namespace tester
+
+#endif // TESTER_STEP_CACHE_H
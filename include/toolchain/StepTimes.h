@@ -0,0 +1,70 @@
+#ifndef TESTER_STEP_TIMES_H
+#define TESTER_STEP_TIMES_H
+
+#include <algorithm>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Convenience.
+namespace fs = std::filesystem;
+
+namespace tester {
+
+// Time limits that follow how long the solution took, instead of one fixed
+// limit for every command.
+struct AdaptiveTimeout {
+  // How many times the solution's time a step gets. Zero when not adapting.
+  double factor{0};
+
+  // The shortest limit a step gets, however quick the solution was.
+  double floor{1};
+
+  bool isEnabled() const { return factor > 0; }
+
+  // The limit of a step the solution ran in `seconds`, never over `limit`.
+  double getLimit(double seconds, double limit) const {
+    return std::min(limit, std::max(floor, factor * seconds));
+  }
+};
+
+// How long each step of each toolchain took the solution on each test.
+// Recorded while the solution runs, and kept between runs in a history file.
+class StepTimes {
+public:
+  StepTimes() = default;
+
+  // The times are shared, not copied.
+  StepTimes(const StepTimes&) = delete;
+  StepTimes& operator=(const StepTimes&) = delete;
+
+  // Record a step's time on a test.
+  void record(const std::string& toolChain, const fs::path& test, size_t step, double seconds);
+
+  // A step's time on a test, if the solution ran it.
+  std::optional<double> find(const std::string& toolChain, const fs::path& test,
+                             size_t step) const;
+
+  // Read times kept by an earlier run, keeping any already recorded. A
+  // missing file is no error, throws if the file is malformed.
+  void load(const fs::path& path);
+
+  // Keep the times for later runs.
+  void save(const fs::path& path) const;
+
+private:
+  typedef std::pair<std::string, std::string> Key;
+
+  mutable std::mutex mutex;
+
+  // The seconds each step took, negative for steps not run.
+  std::map<Key, std::vector<double>> times;
+};
+
+} // End namespace tester
+
+#endif // TESTER_STEP_TIMES_H
@@ -0,0 +1,38 @@
+#ifndef TESTER_TIMING_H
+#define TESTER_TIMING_H
+
+#include <cstdint>
+#include <vector>
+
+namespace tester {
+
+// How many times the final step of a toolchain is run to time it. A single
+// measured run with no warm-ups is the regular, non-statistical behaviour.
+struct TimingPolicy {
+  uint32_t warmups{0};
+  uint32_t repetitions{1};
+
+  bool isStatistical() const { return warmups != 0 || repetitions > 1; }
+};
+
+// Robust summary of the measured runs of a final step (seconds).
+struct TimingStats {
+  double median{0};
+  double mad{0};
+  double min{0};
+  uint32_t warmups{0};
+
+  // Every measured sample, in the order they were taken.
+  std::vector<double> samples;
+
+  // Samples dropped as outliers before computing the summary.
+  std::vector<double> outliers;
+};
+
+// Summarise measured samples: samples further than 3 scaled MADs from the
+// median are rejected, then median, MAD and min are taken over the rest.
+TimingStats summariseTimings(const std::vector<double>& samples, uint32_t warmups);
+
+} // End namespace tester
+
+#endif // TESTER_TIMING_H
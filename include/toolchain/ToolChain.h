@@ -4,9 +4,17 @@
 #include "json.hpp"
 #include "tests/TestFile.h"
 #include "toolchain/Command.h"
+#include "toolchain/Comparator.h"
+#include "toolchain/StepCache.h"
+#include "toolchain/StepTimes.h"
+#include "toolchain/Timing.h"
 
 #include <filesystem>
+#include <functional>
+#include <map>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
 // Convenience.
@@ -15,6 +23,10 @@ namespace fs = std::filesystem;
 
 namespace tester {
 
+// Shown the final step's stdout as it is written, one chunk at a time. Returns
+// false once it has seen enough, which stops the step.
+using OutputWatcher = std::function<bool(std::string_view)>;
+
 // A simple toolchain that assumes that the output file of one step is the input
 // file of the next
 class ToolChain {
@@ -22,22 +34,98 @@ public:
   // There is no default constructor.
   ToolChain() = delete;
 
-  // Construct the ToolChain from a json file path.
+  // Construct the ToolChain from its JSON, either an array of steps or an
+  // object with "steps" and an optional "comparator" spec.
   ToolChain(const JSON& json, int64_t timeout);
 
   // Copy constructor is default copy.
   ToolChain(const ToolChain& tc) = default;
 
-  // Runs the toolchain on a specified inputfile.
-  ExecutionOutput build(TestFile* test) const;
+  // Runs the toolchain on a specified inputfile. If the final step streams its
+  // verdict, its stdout is shown to `watcher` while it runs. Output files go
+  // in `scratchDir` unless it is empty.
+  ExecutionOutput build(TestFile* test, const OutputWatcher& watcher = nullptr,
+                        const fs::path& scratchDir = fs::path()) const;
+
+  // Whether build() shows the final step's stdout to a watcher. Not when the
+  // final step is timed over repeated runs, since every run must finish.
+  bool streamsVerdict() const {
+    return commands.back().streamsVerdict() && !timingPolicy.isStatistical();
+  }
+
+  // Run a batched first step over these tests ahead of time, in as few
+  // invocations as it allows. build() then starts from the results. Results
+  // only last until the next call, and are written to `scratchDir` unless it
+  // is empty.
+  void prepareBatch(const std::vector<TestFile*>& tests, const fs::path& scratchDir = fs::path());
+
+  // Whether prepareBatch runs the first step ahead of time.
+  bool isBatched() const { return commands.front().getBatchSize() != 0; }
+
+  // Whether every step's output files can be moved to a scratch directory,
+  // which tests run at the same time need.
+  bool isRelocatable() const;
+
+  // Identifies every step by everything that decides its output.
+  std::vector<std::string> getStepSignatures() const;
+
+  // Whether a step's output can be kept for other toolchains: it isn't the
+  // final step, doesn't feed a pipe and isn't batched.
+  bool isStepCacheable(size_t step) const;
+
+  // Share the outputs of steps other toolchains also run. `prefixKeys` names
+  // each step along with the steps before it, empty for steps not shared.
+  void setStepCache(std::shared_ptr<StepCache> stepCache_, std::vector<std::string> prefixKeys_) {
+    stepCache = std::move(stepCache_);
+    prefixKeys = std::move(prefixKeys_);
+  }
 
   // Manipulate the executable to be tested.
   void setTestedExecutable(fs::path testedExecutable_) {
     testedExecutable = std::move(testedExecutable_);
+    batched.clear();
   }
 
   // Manipulate the tested runtime.
-  void setTestedRuntime(fs::path testedRuntime_) { testedRuntime = std::move(testedRuntime_); }
+  void setTestedRuntime(fs::path testedRuntime_) {
+    testedRuntime = std::move(testedRuntime_);
+    batched.clear();
+  }
+
+  // Manipulate how the final step is timed.
+  void setTimingPolicy(TimingPolicy timingPolicy_) { timingPolicy = timingPolicy_; }
+  const TimingPolicy& getTimingPolicy() const { return timingPolicy; }
+
+  // Manipulate whether the final step records hardware counters.
+  void setMeasuresCounters(bool measureCounters_) { measureCounters = measureCounters_; }
+
+  // Manipulate whether every step's process group is killed with it.
+  void setKillsProcessGroups(bool kills) {
+    for (Command& command : commands)
+      command.setKillsProcessGroup(kills);
+  }
+
+  // Manipulate the CPUs every step is pinned to.
+  void setCpuAffinity(CpuList cpuAffinity_) { cpuAffinity = std::move(cpuAffinity_); }
+
+  // Limit each step to what `policy` allows for the solution's time on the
+  // test, as recorded in `stepTimes` under the toolchain's `name`. Steps the
+  // solution didn't run keep the usual timeout.
+  void setAdaptiveTimeout(std::shared_ptr<StepTimes> stepTimes_, AdaptiveTimeout policy,
+                          std::string name_) {
+    stepTimes = std::move(stepTimes_);
+    adaptiveTimeout = policy;
+    name = std::move(name_);
+  }
+
+  // Record the steps' times as the solution's rather than be limited by them.
+  void setRecordsStepTimes(bool recordsStepTimes_) { recordsStepTimes = recordsStepTimes_; }
+
+  // How the final step's output is compared to the expected output, unless a
+  // test names its own comparator.
+  const Comparator& getComparator() const {
+    return comparator ? *comparator : Comparator::getExact();
+  }
 
   // Gets a brief description of the toolchain.
   std::string getBriefDescription() const;
@@ -45,15 +133,58 @@ public:
   // Ostream operator.
   friend std::ostream& operator<<(std::ostream&, const ToolChain&);
 
+private:
+  // Identifies a shared prefix ending at `step` run for a test.
+  std::string getPrefixKey(size_t step, const TestFile* test) const;
+
+  // Run the steps first..last, which are all piped from their predecessor
+  // after the first, and return the output of the last. With a watcher, the
+  // last step's stdout passes through it on the way to its file.
+  ExecutionOutput runSteps(size_t first, size_t last, const ExecutionInput& ei,
+                           const OutputWatcher* watcher = nullptr) const;
+
+  // Rerun the final step, along with the steps piped into it starting at
+  // `first`, for warm-ups and repetitions, recording statistics.
+  ExecutionOutput repeatFinalStep(size_t first, const ExecutionInput& ei,
+                                  ExecutionOutput eo, TestFile* test) const;
+
 private:
   // The list of commands to execute this toolchain.
   std::vector<Command> commands;
 
+  // The comparator the toolchain names, exact when it names none.
+  std::shared_ptr<const Comparator> comparator;
+
   // The tested executable.
   fs::path testedExecutable;
 
   // The tested executable's runtime.
   fs::path testedRuntime;
+
+  // Warm-ups and repetitions for the final step.
+  TimingPolicy timingPolicy;
+
+  // The CPU lane the steps run in, empty to not pin them.
+  CpuList cpuAffinity;
+
+  // Record hardware counters for the final step.
+  bool measureCounters{false};
+
+  // Outputs of the step prefixes shared with other toolchains.
+  std::shared_ptr<StepCache> stepCache;
+  std::vector<std::string> prefixKeys;
+
+  // The usual time limit of every step, in seconds.
+  int64_t timeout;
+
+  // The solution's step times, for adaptive timeouts.
+  std::shared_ptr<StepTimes> stepTimes;
+  AdaptiveTimeout adaptiveTimeout;
+  std::string name;
+  bool recordsStepTimes{false};
+
+  // First step results of the tests given to prepareBatch.
+  std::map<const TestFile*, ExecutionOutput> batched;
 };
 
 } // End namespace tester
@@ -1,29 +1,44 @@
 #include "analysis/Grader.h"
+#include "Hash.h"
+
 #include <algorithm>
 #include <iostream>
+#include <iterator>
+#include <set>
 
 namespace {
 
-/// @brief Print the output of a grade test in a way that gives a sense as to 
-/// the overall direction of the tournament results to the terminal viewer.
-/// Tests that pass on stdout are green dots, failures are red dots.
-/// Error tests that pass are a green 'X', failures are red 'X'
-void printGraderTestResult(bool testPass, bool testError) {
-  if (testPass && !testError) {
-    // a regular test that passes
-    std::cout << Colors::GREEN << "." << Colors::RESET;
-    // passCount++;
-  } else if (testPass && testError) {
-    // a test failed due to error but in the expected manner
-    std::cout << Colors::GREEN << "x" << Colors::RESET; 
-    // passCount++;
-  } else if (testPass && testError) {
-    // a test failed due to error unexpectedly
-    std::cout << Colors::RED << "x" << Colors::RESET;
-  } else {
-    // a test that produced a different output
-    std::cout << Colors::RED << "." << Colors::RESET;
+/// @brief Collect the timing of a test's last run for the grade JSON.
+JSON getTimingJSON(const tester::TestFile *test, bool pass) {
+  JSON timingData = {
+    {"test", test->getTestPath().filename()},
+    {"time", test->getElapsedTime()},
+    {"pass", pass}
+  };
+  const std::optional<tester::TimingStats>& stats = test->getTimingStats();
+  if (stats.has_value()) {
+    timingData["stats"] = {
+      {"median", stats->median},
+      {"mad", stats->mad},
+      {"min", stats->min},
+      {"warmups", stats->warmups},
+      {"samples", stats->samples},
+      {"outliers", stats->outliers}
+    };
   }
+  const std::optional<tester::PerfCounters>& counters = test->getPerfCounters();
+  if (counters.has_value()) {
+    auto value = [](const std::optional<uint64_t>& v) {
+      return v.has_value() ? JSON(*v) : JSON(nullptr);
+    };
+    timingData["counters"] = {
+      {"instructions", value(counters->instructions)},
+      {"cycles", value(counters->cycles)},
+      {"branchMisses", value(counters->branchMisses)},
+      {"cacheMisses", value(counters->cacheMisses)}
+    };
+  }
+  return timingData;
 }
 
 } // end anonymous namespace
@@ -81,6 +96,183 @@ void Grader::fillTestSummaryJSON() {
   outputJson["testSummary"] = testSummary;
 }
 
+ToolChain Grader::getToolChainFor(const std::string& toolChainName,
+                                  const std::string& exeName) const {
+  ToolChain tc = cfg.getToolChain(toolChainName);
+  tc.setMeasuresCounters(cfg.usesPerfCounters());
+  tc.setRecordsStepTimes(exeName == solutionExecutable);
+  tc.setTestedExecutable(cfg.getExecutablePath(exeName));
+
+  if (cfg.hasRuntime(exeName))
+    tc.setTestedRuntime(cfg.getRuntimePath(exeName));
+  else
+    tc.setTestedRuntime("");
+  return tc;
+}
+
+size_t Grader::countTests() const {
+  size_t count = 0;
+  for (const auto& package : testSet)
+    for (const auto& subpackage : package.second)
+      count += subpackage.second.size();
+  return count;
+}
+
+size_t Grader::countTournamentRuns() const {
+  size_t count = 0;
+  for (const auto& toolChain : cfg.getToolChains()) {
+    auto runs = solutionRuns.find(toolChain.first);
+    size_t valid = countTests();
+    if (runs != solutionRuns.end())
+      for (const auto& run : runs->second)
+        if (!run.second.pass)
+          --valid;
+    count += valid * defendingExes.size();
+  }
+  return count;
+}
+
+void Grader::fingerprintTests() {
+
+  // Tests are the same if the test file, its input stream and its expected
+  // output are byte for byte the same. Teams often submit copies of a test.
+  auto readFile = [](const fs::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+  };
+  for (const auto& package : testSet) {
+    for (const auto& subpackage : package.second) {
+      for (const std::unique_ptr<TestFile>& test : subpackage.second) {
+        Fnv1a hash;
+        hash.addField(readFile(test->getTestPath()));
+        hash.addField(test->usesInputStream ? readFile(test->getInsPath()) : "");
+        const ExpectedOutput& expected = test->getExpectedOutput();
+        hash.addField(std::string_view(reinterpret_cast<const char*>(&expected.hash),
+                                       sizeof(expected.hash)));
+        fingerprints[test.get()] = hash.get();
+      }
+    }
+  }
+}
+
+Grader::GradedRun Grader::getInvalidRun(const TestFile *test) {
+  JSON timing = {{"test", test->getTestPath().filename()}, {"time", 0}, {"pass", false},
+                 {"invalid", true}};
+  return {false, false, timing, true};
+}
+
+uint64_t Grader::getRunKey(const std::string& toolChainName, const std::string& attacker,
+                           const TestFile *test) const {
+  uint64_t fingerprint = fingerprints.at(test);
+  TimingPolicy policy = cfg.getTimingPolicy(toolChainName, attacker);
+  CpuList cpus = cfg.getCpuAffinity(toolChainName, attacker);
+  Fnv1a hash;
+  hash.addField(std::string_view(reinterpret_cast<const char*>(&fingerprint), sizeof(fingerprint)));
+  hash.addField(std::string_view(reinterpret_cast<const char*>(&policy.warmups),
+                                 sizeof(policy.warmups)));
+  hash.addField(std::string_view(reinterpret_cast<const char*>(&policy.repetitions),
+                                 sizeof(policy.repetitions)));
+  hash.addField(std::string_view(reinterpret_cast<const char*>(cpus.data()),
+                                 cpus.size() * sizeof(int)));
+  return hash.get();
+}
+
+std::unique_ptr<TestPipeline> Grader::startPlan(const std::string& toolChainName,
+                                                const std::string& exeName,
+                                                const TestPlan& plan) {
+  // Each attacker's tests run with the toolchain set up for its package, and
+  // only the first of identical runs happens.
+  ToolChain tc = getToolChainFor(toolChainName, exeName);
+  std::vector<TestGroup> groups;
+  std::set<uint64_t> scheduled;
+  for (size_t i = 0; i < plan.size(); ++i) {
+    tc.setTimingPolicy(cfg.getTimingPolicy(toolChainName, attackingTestPackages[i]));
+    tc.setCpuAffinity(cfg.getCpuAffinity(toolChainName, attackingTestPackages[i]));
+    TestGroup group{std::make_shared<ToolChain>(tc), {}};
+    for (const PlannedTest& planned : plan[i])
+      if (!planned.known.has_value() &&
+          scheduled.insert(getRunKey(toolChainName, attackingTestPackages[i], planned.test)).second)
+        group.tests.push_back(planned.test);
+    groups.push_back(std::move(group));
+  }
+  return std::make_unique<TestPipeline>(cfg, std::move(groups), progress);
+}
+
+Grader::GradedRun Grader::takeRun(TestPipeline& pipeline, const std::string& toolChainName,
+                                  const std::string& attacker, const PlannedTest& planned,
+                                  std::map<uint64_t, GradedRun>& done) {
+  if (planned.known.has_value())
+    return *planned.known;
+
+  const TestFile *test = planned.test;
+  uint64_t key = getRunKey(toolChainName, attacker, test);
+  auto found = done.find(key);
+  if (found != done.end()) {
+    // A copy of a test that already ran, which only differs in its name.
+    GradedRun copy = found->second;
+    copy.timing["test"] = test->getTestPath().filename();
+    ++dedupedRuns;
+    return copy;
+  }
+
+  JudgedTest judged = pipeline.takeResult();
+  std::cout << judged.log;
+  GradedRun run{judged.result.pass, judged.result.error, getTimingJSON(test, judged.result.pass)};
+  done.emplace(key, run);
+  return run;
+}
+
+void Grader::validateTests() {
+
+  // Run the solution over every test once, so tests that break it are logged
+  // and left out before each defender runs them.
+  if (std::find(defendingExes.begin(), defendingExes.end(), solutionExecutable) ==
+      defendingExes.end()) {
+    std::cout << "Solution " << solutionExecutable << " is not a tested executable, "
+              << "tests are not validated" << std::endl;
+    return;
+  }
+
+  std::cout << "Validating tests against the solution: " << solutionExecutable << std::endl;
+  size_t invalidCount = 0;
+  for (const auto& toolChain : cfg.getToolChains()) {
+    const std::string& toolChainName = toolChain.first;
+    std::cout << "Validating toolchain: " << toolChainName << std::endl;
+    std::map<const TestFile*, GradedRun>& runs = solutionRuns[toolChainName];
+
+    TestPlan plan;
+    for (const std::string& attacker : attackingTestPackages) {
+      plan.emplace_back();
+      for (const auto& subpackages : testSet[attacker])
+        for (const std::unique_ptr<TestFile>& test : subpackages.second)
+          plan.back().push_back({test.get(), std::nullopt});
+    }
+    std::unique_ptr<TestPipeline> pipeline = startPlan(toolChainName, solutionExecutable, plan);
+    std::map<uint64_t, GradedRun> done;
+
+    for (size_t i = 0; i < plan.size(); ++i) {
+      const std::string& attacker = attackingTestPackages[i];
+      std::cout << "  (" << attacker << ") ";
+      for (const PlannedTest& planned : plan[i]) {
+        GradedRun run = takeRun(*pipeline, toolChainName, attacker, planned, done);
+        if (!run.pass) {
+          trackSolutionFailure(planned.test, toolChainName, attacker);
+          ++invalidCount;
+        }
+        runs.emplace(planned.test, run);
+        reporter.gradeResult(run.pass, run.error);
+        progress.cellDone();
+      }
+      std::cout << '\n';
+    }
+    if (cfg.showsPipelineStats())
+      std::cout << pipeline->getStatistics();
+  }
+  failedTestLog.flush();
+  std::cout << invalidCount << " test runs fail the solution and are marked invalid in the tournament"
+            << std::endl;
+}
+
 void Grader::fillToolchainResultsJSON() {
 
   // Start running tests. Make a pass rate table for each toolchain.
@@ -91,18 +283,10 @@ void Grader::fillToolchainResultsJSON() {
     JSON toolChainJson = {{"toolchain", toolChain.first}, {"toolchainResults", JSON::array()}};
     std::cout << "Toolchain: " << toolChain.first << std::endl;
 
-    // Get the toolchain and start running tests. Run over names twice since it's nxn.
-    ToolChain tc = toolChain.second;
+    // Run over names twice since it's nxn.
     for (const std::string& defender : defendingExes) {
 
       JSON defenseResults = {{"defender", defender}, {"defenderResults", JSON::array()}};
-      // Set up the tool chain with the defender's executable.
-      tc.setTestedExecutable(cfg.getExecutablePath(defender));
-
-      if (cfg.hasRuntime(defender))
-        tc.setTestedRuntime(cfg.getRuntimePath(defender));
-      else
-        tc.setTestedRuntime("");
 
       // Find max string length of team name for formatting stdout  
       auto maxNameLength = static_cast<int>(std::max_element(
@@ -112,8 +296,35 @@ void Grader::fillToolchainResultsJSON() {
         }
       )->size());
 
-      // Iterate over attackers.
+      // Tests that fail the solution are not run and are marked invalid, and
+      // the solution's own results are already known.
+      const std::map<const TestFile*, GradedRun>& runs = solutionRuns[toolChainName];
+      TestPlan plan;
       for (const std::string& attacker : attackingTestPackages) {
+        plan.emplace_back();
+        for (const auto& subpackages : testSet[attacker]) {
+          for (const std::unique_ptr<TestFile>& test : subpackages.second) {
+            auto run = runs.find(test.get());
+            if (run == runs.end())
+              plan.back().push_back({test.get(), std::nullopt});
+            else if (!run->second.pass)
+              plan.back().push_back({test.get(), getInvalidRun(test.get())});
+            else if (defender == solutionExecutable)
+              plan.back().push_back({test.get(), run->second});
+            else
+              plan.back().push_back({test.get(), std::nullopt});
+          }
+        }
+      }
+
+      // Each distinct test runs once against the defender, copies of it in
+      // other attackers' packages get the same result.
+      std::unique_ptr<TestPipeline> pipeline = startPlan(toolChainName, defender, plan);
+      std::map<uint64_t, GradedRun> done;
+
+      // Iterate over attackers.
+      for (size_t i = 0; i < plan.size(); ++i) {
+        const std::string& attacker = attackingTestPackages[i];
         
         std::cout << "  " << std::left << std::setw(maxNameLength + 2) << ("(" + attacker + ")") // +2 for the parentheses
           << " --> "
@@ -121,51 +332,44 @@ void Grader::fillToolchainResultsJSON() {
         
         JSON attackResults = {{"attacker", attacker}, {"timings", JSON::array()}};
 
-        // Iterate over subpackages and the contained tests from the
-        // attacker, tracking pass count.
-        size_t passCount = 0, testCount = 0;
-        for (const auto& subpackages : testSet[attacker]) {
-          for (const std::unique_ptr<TestFile>& test : subpackages.second) {
-
-            TestResult result = runTest(test.get(), tc, cfg);
-            
-            if (!result.pass && defender == solutionExecutable) {
-              if ( attacker == solutionExecutable ) {
-                // A testcase just failed the solution executable
-                throw std::runtime_error("A solution test just made the solution compiler fail!");
-              }
-              trackSolutionFailure(test.get(), toolChain.first, attacker);
-            }
-            if (result.pass) {
-              passCount++;
-            }
-            // Print the test result in a nice to read format.
-            printGraderTestResult(result.pass, result.error);
-
-            std::cout.flush();
-            testCount++;
-            JSON timingData = {
-              {"test", test->getTestPath().filename()},
-              {"time", test->getElapsedTime()},
-              {"pass", result.pass}
-            };
-            attackResults["timings"].push_back(timingData);
+        // Iterate over the tests from the attacker, tracking pass count.
+        // Invalid tests are listed and counted, but print nothing.
+        size_t passCount = 0, testCount = 0, invalidCount = 0;
+        for (const PlannedTest& planned : plan[i]) {
+          GradedRun run = takeRun(*pipeline, toolChainName, attacker, planned, done);
+          testCount++;
+          attackResults["timings"].push_back(run.timing);
+          if (run.invalid) {
+            invalidCount++;
+            continue;
+          }
+          if (run.pass) {
+            passCount++;
           }
+          // Print the test result in a nice to read format.
+          reporter.gradeResult(run.pass, run.error);
+          progress.cellDone();
         }
         // update the test results
         attackResults["passCount"] = passCount;
         attackResults["testCount"] = testCount;
+        attackResults["invalidCount"] = invalidCount;
         defenseResults["defenderResults"].push_back(attackResults);
 
         std::cout << '\n';
       }
       // add the defense results
       toolChainJson["toolchainResults"].push_back(defenseResults);
+      if (cfg.showsPipelineStats())
+        std::cout << pipeline->getStatistics();
     }
     // add the results for the entire toolchain
     outputJson["results"].push_back(toolChainJson);
   }
 
+  if (dedupedRuns != 0)
+    std::cout << "Saved " << dedupedRuns << " test runs by running identical tests once"
+              << std::endl;
 }
 
 void Grader::buildResults() {
@@ -174,6 +378,18 @@ void Grader::buildResults() {
   outputJson["results"] = JSON::array();
 
   fillTestSummaryJSON();
+  fingerprintTests();
+
+  // The solution runs every test once with each toolchain, then the tests it
+  // passes run against every defender.
+  bool validates = std::find(defendingExes.begin(), defendingExes.end(), solutionExecutable) !=
+                   defendingExes.end();
+  progress.setRemaining((validates ? countTests() * cfg.getToolChains().size() : 0) +
+                        countTournamentRuns());
+  validateTests();
+  if (cfg.getTimingHistoryPath().has_value())
+    cfg.getStepTimes()->save(*cfg.getTimingHistoryPath());
+  progress.setRemaining(countTournamentRuns());
   fillToolchainResultsJSON();
 }
 
@@ -31,6 +31,38 @@ Config::Config(int argc, char** argv) : timeout(2l) {
   app.add_option("--timeout", timeout, "Specify timeout length for EACH command in a toolchain.");
   app.add_option("--debug-package", debugPackage, "Provide a sub-path to run the tester on.");
   app.add_flag("-t,--time", time, "Include the timings (seconds) of each test in the output.");
+  app.add_flag("--perf-counters", perfCounters,
+               "Record hardware performance counters of the final toolchain step.");
+  app.add_flag("--kill-process-groups", killProcessGroups,
+               "Run each command in its own process group and kill the group with it.");
+  bool sharedSteps = false;
+  app.add_flag("--shared-steps", sharedSteps,
+               "Run steps shared by several toolchains once per executable and test.");
+  app.add_option("-j,--jobs", jobs, "Number of tests to run at the same time.")
+      ->check(CLI::Range(1u, 1024u));
+  app.add_option("--compare-jobs", compareJobs,
+                 "Number of threads comparing outputs, a quarter of the jobs by default.")
+      ->check(CLI::Range(1u, 1024u));
+  app.add_flag("--pipeline-stats", pipelineStats,
+               "Print queue depths and how busy each stage of the test pipeline was.");
+  app.add_option("--adaptive-timeout", adaptiveTimeout.factor,
+                 "Limit each step to this many times the solution's time on the test.")
+      ->check(CLI::Range(0.0, 1e6));
+  app.add_option("--timeout-floor", adaptiveTimeout.floor,
+                 "Shortest adaptive step time limit in seconds, 1 by default.")
+      ->check(CLI::Range(0.0, 1e6));
+  app.add_option("--timing-history", timingHistoryPath,
+                 "Read the solution's step times from this file and keep them in it.");
+  app.add_option("--metrics-file", metricsFilePath,
+                 "Write Prometheus metrics to this file, for a textfile collector.");
+  app.add_option("--metrics-port", metricsPort,
+                 "Serve Prometheus metrics over HTTP on this local port.")
+      ->check(CLI::Range(1u, 65535u));
+  app.add_option("--metrics-interval", metricsInterval,
+                 "Seconds between writes of the metrics file, 15 by default.")
+      ->check(CLI::Range(1u, 86400u));
+  app.add_flag("--progress", progress,
+               "Show tests done, throughput, latency, active workers and an ETA while running.");
   app.add_flag_function("-v", [&](size_t count) { verbosity = static_cast<int>(count); },
                         "Increase verbosity level");
   
@@ -49,6 +81,8 @@ Config::Config(int argc, char** argv) : timeout(2l) {
     errorCode = app.exit(e);
     return;
   }
+  if (compareJobs == 0)
+    compareJobs = (jobs + 3) / 4;
 
   // Get our json file.
   std::ifstream jsonFile(configFilePath);
@@ -105,7 +139,95 @@ Config::Config(int argc, char** argv) : timeout(2l) {
 
   for (auto it = tcJson.begin(); it != tcJson.end(); ++it) {
     toolchains.emplace(std::make_pair(it.key(), ToolChain(it.value(), timeout)));
+    toolchains.at(it.key()).setKillsProcessGroups(killProcessGroups);
   }
+  if (sharedSteps)
+    planSharedSteps();
+
+  // Steps are limited by the solution's times once it has run, or as soon as
+  // a history has them.
+  if (adaptiveTimeout.isEnabled() || timingHistoryPath.has_value()) {
+    if (!solutionExecutable.has_value() && !timingHistoryPath.has_value())
+      throw std::runtime_error("Adaptive timeouts need a solutionExecutable or a --timing-history.");
+    stepTimes = std::make_shared<StepTimes>();
+    if (timingHistoryPath.has_value())
+      stepTimes->load(*timingHistoryPath);
+    for (auto& [name, toolChain] : toolchains)
+      toolChain.setAdaptiveTimeout(stepTimes, adaptiveTimeout, name);
+  }
+
+  // Parse out the optional statistical timing set up.
+  if (doesContain(json, "timing")) {
+    const JSON& timingJson = json["timing"];
+    if (!timingJson.is_object())
+      throw std::runtime_error("Timing is not an object.");
+
+    if (doesContain(timingJson, "warmups"))
+      timingPolicy.warmups = timingJson["warmups"];
+    if (doesContain(timingJson, "repetitions"))
+      timingPolicy.repetitions = timingJson["repetitions"];
+    if (timingPolicy.repetitions == 0)
+      throw std::runtime_error("Timing repetitions must be at least 1.");
+
+    if (doesContain(timingJson, "toolchains"))
+      timedToolChains = timingJson["toolchains"].get<std::set<std::string>>();
+    if (doesContain(timingJson, "packages"))
+      timedPackages = timingJson["packages"].get<std::set<std::string>>();
+
+    // Either a number of physical cores or an explicit list of CPUs.
+    if (doesContain(timingJson, "exclusiveCores")) {
+      const JSON& coresJson = timingJson["exclusiveCores"];
+      if (coresJson.is_array())
+        cpuLanes = CpuLanes::reserveCpus(coresJson.get<CpuList>());
+      else
+        cpuLanes = CpuLanes::reserveCores(coresJson.get<unsigned int>());
+    }
+  }
+}
+
+void Config::planSharedSteps() {
+  // Name every step by itself and the steps before it, a prefix tree of all
+  // the toolchains. Prefixes more than one toolchain can reuse are shared.
+  std::map<std::string, std::vector<std::string>> prefixKeys;
+  std::map<std::string, unsigned int> users;
+  for (const auto& [name, toolChain] : toolchains) {
+    std::string prefix;
+    for (const std::string& signature : toolChain.getStepSignatures()) {
+      prefix += signature + '\n';
+      size_t step = prefixKeys[name].size();
+      prefixKeys[name].push_back(toolChain.isStepCacheable(step) ? prefix : "");
+      if (toolChain.isStepCacheable(step))
+        ++users[prefix];
+    }
+  }
+
+  stepCache = std::make_shared<StepCache>();
+  for (auto& [name, toolChain] : toolchains) {
+    std::vector<std::string>& keys = prefixKeys[name];
+    for (std::string& key : keys)
+      if (!key.empty() && users[key] < 2)
+        key.clear();
+    toolChain.setStepCache(stepCache, std::move(keys));
+  }
+}
+
+bool Config::inTimingScope(const std::string& toolChain, const std::string& package) const {
+  if (timedToolChains.has_value() && timedToolChains->count(toolChain) == 0)
+    return false;
+  if (timedPackages.has_value() && timedPackages->count(package) == 0)
+    return false;
+  return true;
+}
+
+TimingPolicy Config::getTimingPolicy(const std::string& toolChain,
+                                     const std::string& package) const {
+  return inTimingScope(toolChain, package) ? timingPolicy : TimingPolicy();
+}
+
+CpuList Config::getCpuAffinity(const std::string& toolChain, const std::string& package) const {
+  if (!cpuLanes.isEnabled())
+    return {};
+  return inTimingScope(toolChain, package) ? cpuLanes.getTimedCpus() : cpuLanes.getSharedCpus();
 }
 
 } // namespace tester
\ No newline at end of file
@@ -0,0 +1,283 @@
+#include "testharness/ConsoleReporter.h"
+
+#include "Colors.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+namespace {
+
+// How often the console is written at most.
+constexpr std::chrono::milliseconds REFRESH_INTERVAL(50);
+
+// Output waiting past this size makes whoever writes more wait for the
+// console, rather than holding on to it all.
+constexpr size_t MAX_PENDING = 64 << 20;
+
+// The columns a line of terminal output takes, skipping colour codes.
+size_t visibleWidth(const std::string& line) {
+  size_t width = 0;
+  for (size_t i = 0; i < line.size(); ++i) {
+    if (line[i] == '\033' && i + 1 < line.size() && line[i + 1] == '[') {
+      i += 2;
+      while (i < line.size() && (line[i] < '@' || line[i] > '~'))
+        ++i;
+    } else if ((static_cast<unsigned char>(line[i]) & 0xC0) != 0x80) {
+      ++width;
+    }
+  }
+  return width;
+}
+
+// The width of the terminal on a file descriptor.
+size_t terminalColumns(int fd) {
+  winsize size{};
+  if (ioctl(fd, TIOCGWINSZ, &size) == 0 && size.ws_col != 0)
+    return size.ws_col;
+  return 80;
+}
+
+} // End anonymous namespace
+
+namespace tester {
+
+// A stream buffer that collects what is written to it and has a thread copy
+// it to the console.
+class ConsoleReporter::Buffer : public std::streambuf {
+public:
+  explicit Buffer(std::streambuf* console)
+      : console(console), statusOnStderr(isatty(STDERR_FILENO)),
+        statusOnConsole(statusOnStderr && isatty(STDOUT_FILENO)),
+        writer(&Buffer::writeOut, this) {}
+
+  ~Buffer() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stopping = true;
+    }
+    wake.notify_all();
+    writer.join();
+  }
+
+  // Wait until everything appended so far is written.
+  void flush() {
+    std::unique_lock<std::mutex> lock(mutex);
+    size_t target = appended;
+    ++flushers;
+    wake.notify_all();
+    written.wait(lock, [&]() { return writtenUpTo >= target; });
+    --flushers;
+  }
+
+  // Show a new status line, or none if it's empty.
+  void setStatus(std::string line) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      status = std::move(line);
+      statusChanged = true;
+    }
+    wake.notify_all();
+  }
+
+protected:
+  int_type overflow(int_type c) override {
+    if (!traits_type::eq_int_type(c, traits_type::eof())) {
+      char ch = traits_type::to_char_type(c);
+      append(&ch, 1);
+    }
+    return traits_type::not_eof(c);
+  }
+
+  std::streamsize xsputn(const char* s, std::streamsize n) override {
+    append(s, n);
+    return n;
+  }
+
+  // The writer keeps to its own schedule, so flushing std::cout is free.
+  int sync() override { return 0; }
+
+private:
+  void append(const char* s, size_t n) {
+    std::unique_lock<std::mutex> lock(mutex);
+    written.wait(lock, [this]() { return pending.size() < MAX_PENDING; });
+    pending.append(s, n);
+    appended += n;
+    wake.notify_all();
+  }
+
+  void writeOut() {
+    std::unique_lock<std::mutex> lock(mutex);
+    auto lastWrite = std::chrono::steady_clock::now() - REFRESH_INTERVAL;
+    while (true) {
+      wake.wait(lock, [this]() { return stopping || !pending.empty() || statusChanged; });
+      if (pending.empty() && !statusChanged)
+        break;
+
+      // Gather output until it is time to write again, unless it is wanted now.
+      wake.wait_until(lock, lastWrite + REFRESH_INTERVAL,
+                      [this]() { return stopping || flushers != 0; });
+
+      std::string chunk;
+      chunk.swap(pending);
+      size_t upTo = appended;
+      std::optional<std::string> newStatus;
+      if (statusChanged)
+        newStatus = status;
+      statusChanged = false;
+      lock.unlock();
+      render(chunk, newStatus);
+      lock.lock();
+
+      lastWrite = std::chrono::steady_clock::now();
+      writtenUpTo = upTo;
+      written.notify_all();
+    }
+  }
+
+  // Write output to the console, keeping the status line below it when they
+  // share the terminal. Only the writer thread calls this.
+  void render(const std::string& chunk, const std::optional<std::string>& newStatus) {
+    if (newStatus.has_value())
+      shownStatus = *newStatus;
+
+    if (!statusOnConsole) {
+      console->sputn(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+      console->pubsync();
+      if (newStatus.has_value() && statusOnStderr && (statusShown || !shownStatus.empty())) {
+        std::cerr << "\r\033[K" << fitStatus(STDERR_FILENO) << std::flush;
+        statusShown = !shownStatus.empty();
+      }
+      return;
+    }
+
+    // Take the status line off, putting the cursor back where the output
+    // stopped, then write the output and the status line after it.
+    std::string out;
+    if (statusShown) {
+      out += "\r\033[K";
+      if (!unfinishedLine.empty()) {
+        size_t columns = terminalColumns(STDOUT_FILENO);
+        size_t rows = (std::max<size_t>(visibleWidth(unfinishedLine), 1) + columns - 1) / columns;
+        out += "\033[" + std::to_string(rows) + "A\r\033[J" + unfinishedLine;
+      }
+      statusShown = false;
+    }
+    out += chunk;
+
+    size_t newline = chunk.rfind('\n');
+    if (newline == std::string::npos)
+      unfinishedLine += chunk;
+    else
+      unfinishedLine = chunk.substr(newline + 1);
+
+    if (!shownStatus.empty()) {
+      out += std::string(unfinishedLine.empty() ? "" : "\n") + "\033[0m" + fitStatus(STDOUT_FILENO);
+      statusShown = true;
+    }
+    console->sputn(out.data(), static_cast<std::streamsize>(out.size()));
+    console->pubsync();
+  }
+
+  // The status line, cut to fit on one line of the terminal.
+  std::string fitStatus(int fd) const {
+    size_t columns = terminalColumns(fd);
+    return shownStatus.size() < columns ? shownStatus : shownStatus.substr(0, columns - 1);
+  }
+
+private:
+  std::streambuf* console;
+
+  std::mutex mutex;
+  std::condition_variable wake, written;
+  std::string pending;
+  size_t appended{0}, writtenUpTo{0};
+  unsigned int flushers{0};
+  bool stopping{false};
+
+  // The status line as set, and as last written by the writer thread along
+  // with the output line it sits under.
+  std::string status, shownStatus, unfinishedLine;
+  bool statusChanged{false}, statusShown{false};
+
+  // Whether stderr is a terminal to show the status line on, and whether
+  // stdout is too, so the status line has to stay out of the output's way.
+  const bool statusOnStderr, statusOnConsole;
+
+  // Started last, once everything it uses is set up.
+  std::thread writer;
+};
+
+ConsoleReporter::ConsoleReporter(const Config& cfg)
+    : cfg(cfg), console(std::cout.rdbuf()), buffer(std::make_unique<Buffer>(console)) {
+  std::cout.rdbuf(buffer.get());
+}
+
+ConsoleReporter::~ConsoleReporter() {
+  buffer->setStatus("");
+  buffer->flush();
+  std::cout.rdbuf(console);
+}
+
+void ConsoleReporter::flush() { buffer->flush(); }
+
+void ConsoleReporter::setStatus(std::string line) { buffer->setStatus(std::move(line)); }
+
+void ConsoleReporter::testResult(const TestFile* test, const TestResult& result) {
+  std::cout << "    "
+            << (result.pass ? (Colors::GREEN + "[PASS]" + Colors::RESET)
+                            : (Colors::RED + "[FAIL]" + Colors::RESET))
+            << " " << std::setw(40) << std::left << test->getTestPath().stem().string();
+  if (cfg.isTimed()) {
+    double time = test->getElapsedTime();
+
+    if (time != 0) {
+      std::cout << std::fixed << std::setw(10) << std::setprecision(6)
+                << test->getElapsedTime() << "(s)";
+    }
+
+    // Repeated runs report the median above, followed by its spread.
+    const std::optional<TimingStats>& stats = test->getTimingStats();
+    if (stats.has_value() && !stats->samples.empty()) {
+      std::cout << " ±" << stats->mad << " min " << stats->min << " n=" << stats->samples.size();
+      if (!stats->outliers.empty())
+        std::cout << " (" << stats->outliers.size() << " outliers)";
+    }
+  }
+  const std::optional<PerfCounters>& counters = test->getPerfCounters();
+  if (counters.has_value()) {
+    auto print = [](const char* name, const std::optional<uint64_t>& value) {
+      if (value.has_value())
+        std::cout << " " << name << " " << *value;
+    };
+    print("instructions", counters->instructions);
+    print("cycles", counters->cycles);
+    print("branch-misses", counters->branchMisses);
+    print("cache-misses", counters->cacheMisses);
+  }
+  std::cout << "\n";
+}
+
+void ConsoleReporter::gradeResult(bool pass, bool error) {
+  if (pass && !error) {
+    // a regular test that passes
+    std::cout << Colors::GREEN << "." << Colors::RESET;
+  } else if (pass && error) {
+    // a test failed due to error but in the expected manner
+    std::cout << Colors::GREEN << "x" << Colors::RESET;
+  } else {
+    // a test that produced a different output
+    std::cout << Colors::RED << "." << Colors::RESET;
+  }
+}
+
+} // End namespace tester
@@ -0,0 +1,164 @@
+#include "testharness/MetricsExporter.h"
+
+#include "toolchain/Metrics.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+// How long the server waits for a request before checking if it should stop,
+// and how long a client has to send its request.
+constexpr int POLL_MILLISECONDS = 200;
+constexpr int REQUEST_MILLISECONDS = 1000;
+
+// Write all of a string to a socket, giving up if the client went away.
+void sendAll(int fd, const std::string& data) {
+  size_t sent = 0;
+  while (sent < data.size()) {
+    ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+    if (n == -1 && errno == EINTR)
+      continue;
+    if (n <= 0)
+      return;
+    sent += static_cast<size_t>(n);
+  }
+}
+
+// Read a request's head, up to the blank line ending it.
+std::string readRequest(int fd) {
+  std::string request;
+  char buffer[1024];
+  pollfd client{fd, POLLIN, 0};
+  while (request.find("\r\n\r\n") == std::string::npos && request.size() < 8192) {
+    if (poll(&client, 1, REQUEST_MILLISECONDS) <= 0)
+      break;
+    ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+    if (n == -1 && errno == EINTR)
+      continue;
+    if (n <= 0)
+      break;
+    request.append(buffer, static_cast<size_t>(n));
+  }
+  return request;
+}
+
+} // End anonymous namespace
+
+namespace tester {
+
+MetricsExporter::MetricsExporter(const Config& cfg) : cfg(cfg) {
+  if (cfg.getMetricsPort() != 0) {
+    listener = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    int reuse = 1;
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<uint16_t>(cfg.getMetricsPort()));
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (listener == -1 ||
+        setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) == -1 ||
+        bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == -1 ||
+        listen(listener, 16) == -1) {
+      std::cerr << "Metrics are not served: can't listen on port " << cfg.getMetricsPort()
+                << ": " << std::strerror(errno) << '\n';
+      if (listener != -1)
+        close(listener);
+      listener = -1;
+    } else {
+      server = std::thread(&MetricsExporter::serve, this);
+    }
+  }
+
+  if (cfg.getMetricsFilePath().has_value())
+    writer = std::thread(&MetricsExporter::writeFiles, this);
+}
+
+MetricsExporter::~MetricsExporter() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  stopCv.notify_all();
+  if (writer.joinable())
+    writer.join();
+  if (server.joinable())
+    server.join();
+  if (listener != -1)
+    close(listener);
+
+  // The final counts, once everything is done.
+  if (cfg.getMetricsFilePath().has_value())
+    writeFile();
+}
+
+void MetricsExporter::writeFile() {
+  const fs::path& path = *cfg.getMetricsFilePath();
+  fs::path temporary = path;
+  temporary += ".tmp";
+  {
+    std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+    file << Metrics::get().render();
+    if (!file) {
+      std::cerr << "Can't write metrics to " << temporary << '\n';
+      return;
+    }
+  }
+  std::error_code ec;
+  fs::rename(temporary, path, ec);
+  if (ec)
+    std::cerr << "Can't write metrics to " << path << ": " << ec.message() << '\n';
+}
+
+void MetricsExporter::writeFiles() {
+  std::unique_lock<std::mutex> lock(mutex);
+  auto interval = std::chrono::seconds(cfg.getMetricsInterval());
+  do {
+    lock.unlock();
+    writeFile();
+    lock.lock();
+  } while (!stopCv.wait_for(lock, interval, [this]() { return stopping; }));
+}
+
+void MetricsExporter::serve() {
+  pollfd waiting{listener, POLLIN, 0};
+  while (true) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (stopping)
+        return;
+    }
+    if (poll(&waiting, 1, POLL_MILLISECONDS) <= 0)
+      continue;
+    int client = accept4(listener, nullptr, nullptr, SOCK_CLOEXEC);
+    if (client == -1)
+      continue;
+
+    // Anything asking for / or /metrics gets the metrics.
+    std::string request = readRequest(client);
+    std::string path = request.substr(0, request.find("\r\n"));
+    std::string response;
+    if (path.rfind("GET /metrics ", 0) == 0 || path.rfind("GET / ", 0) == 0) {
+      std::string body = Metrics::get().render();
+      response = "HTTP/1.1 200 OK\r\n"
+                 "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+                 "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                 "Connection: close\r\n\r\n" + body;
+    } else {
+      response = "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+    }
+    sendAll(client, response);
+    close(client);
+  }
+}
+
+} // End namespace tester
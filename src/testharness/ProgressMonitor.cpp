@@ -0,0 +1,140 @@
+#include "testharness/ProgressMonitor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#include <unistd.h>
+
+namespace {
+
+// How often the status line is redrawn, and how often a log line is written
+// when stderr isn't a terminal.
+constexpr std::chrono::milliseconds STATUS_INTERVAL(500);
+constexpr std::chrono::seconds LOG_INTERVAL(10);
+
+// A duration like 1h02m03s.
+std::string formatDuration(double seconds) {
+  long total = std::lround(seconds);
+  std::ostringstream oss;
+  oss << std::setfill('0');
+  if (total >= 3600)
+    oss << total / 3600 << 'h' << std::setw(2) << total / 60 % 60 << 'm' << std::setw(2)
+        << total % 60 << 's';
+  else if (total >= 60)
+    oss << total / 60 << 'm' << std::setw(2) << total % 60 << 's';
+  else
+    oss << total << 's';
+  return oss.str();
+}
+
+// A latency in milliseconds, or seconds once it is long.
+std::string formatLatency(double seconds) {
+  std::ostringstream oss;
+  oss << std::fixed;
+  if (seconds < 1)
+    oss << std::setprecision(1) << seconds * 1000 << "ms";
+  else
+    oss << std::setprecision(2) << seconds << 's';
+  return oss.str();
+}
+
+} // End anonymous namespace
+
+namespace tester {
+
+ProgressMonitor::ProgressMonitor(const Config& cfg, ConsoleReporter& reporter)
+    : cfg(cfg), reporter(reporter), onTerminal(isatty(STDERR_FILENO)), start(Clock::now()) {
+  if (cfg.showsProgress())
+    thread = std::thread(&ProgressMonitor::show, this);
+}
+
+ProgressMonitor::~ProgressMonitor() {
+  if (!thread.joinable())
+    return;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  stopCv.notify_all();
+  thread.join();
+}
+
+void ProgressMonitor::setRemaining(size_t cells) { total = done + cells; }
+
+void ProgressMonitor::cellDone() { ++done; }
+
+void ProgressMonitor::testStarted() { ++running; }
+
+void ProgressMonitor::testFinished(double seconds, bool timedOut) {
+  --running;
+  ++ran;
+  if (timedOut)
+    ++timeouts;
+  latencyNanos += static_cast<int64_t>(seconds * 1e9);
+
+  double bucket = std::floor(BUCKETS_PER_DOUBLING * std::log2(std::max(seconds, 1e-6) / 1e-6));
+  ++latencies[std::min(static_cast<size_t>(bucket), BUCKETS - 1)];
+}
+
+double ProgressMonitor::getLatencyQuantile(double fraction) const {
+  uint64_t count = 0;
+  for (const std::atomic<uint64_t>& bucket : latencies)
+    count += bucket;
+
+  // Report the top of the bucket the quantile falls in.
+  uint64_t seen = 0;
+  for (size_t i = 0; i < BUCKETS; ++i) {
+    seen += latencies[i];
+    if (seen != 0 && seen >= fraction * count)
+      return 1e-6 * std::exp2((i + 1) / BUCKETS_PER_DOUBLING);
+  }
+  return 0;
+}
+
+std::string ProgressMonitor::getSummary() const {
+  double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+  size_t doneNow = done, totalNow = std::max<size_t>(total, doneNow), ranNow = ran;
+
+  std::ostringstream oss;
+  oss << std::fixed << std::setprecision(1);
+  oss << doneNow << '/' << totalNow << " cells";
+  if (totalNow != 0)
+    oss << " (" << 100.0 * doneNow / totalNow << "%)";
+  oss << " | " << (elapsed > 0 ? ranNow / elapsed : 0) << " tests/s";
+  if (ranNow != 0)
+    oss << " | latency avg " << formatLatency(latencyNanos / 1e9 / ranNow) << " p99 "
+        << formatLatency(getLatencyQuantile(0.99));
+  oss << " | " << running << '/' << cfg.getJobs() << " workers";
+  oss << " | " << timeouts << " timeouts";
+
+  // Reused results make some cells free, so the rate of cells over the whole
+  // run is a better guide than the time a test takes.
+  oss << " | elapsed " << formatDuration(elapsed) << " ETA ";
+  if (doneNow == 0 || elapsed <= 0)
+    oss << "--";
+  else
+    oss << formatDuration((totalNow - doneNow) * elapsed / doneNow);
+  return oss.str();
+}
+
+void ProgressMonitor::show() {
+  std::unique_lock<std::mutex> lock(mutex);
+  auto interval = onTerminal ? Clock::duration(STATUS_INTERVAL) : Clock::duration(LOG_INTERVAL);
+  while (!stopCv.wait_for(lock, interval, [this]() { return stopping; })) {
+    if (onTerminal)
+      reporter.setStatus("[PROGRESS] " + getSummary());
+    else
+      std::cerr << "[PROGRESS] " << getSummary() << std::endl;
+  }
+
+  if (onTerminal)
+    reporter.setStatus("");
+  else
+    std::cerr << "[PROGRESS] " << getSummary() << std::endl;
+}
+
+} // End namespace tester
@@ -1,9 +1,11 @@
 #include "testharness/TestHarness.h"
 
+#include "testharness/TestPipeline.h"
 #include "tests/TestResult.h"
 #include "tests/TestRunning.h"
 #include "util.h"
 
+#include <algorithm>
 #include <filesystem>
 #include <iostream>
 #include <sstream>
@@ -14,14 +16,41 @@ namespace tester {
 // Builds TestSet during object creation.
 bool TestHarness::runTests() {
   bool failed = false;
+
+  // Every valid test runs once per executable and toolchain.
+  size_t testCount = 0;
+  for (const auto& package : testSet)
+    for (const auto& subPackage : package.second)
+      for (const std::unique_ptr<TestFile>& test : subPackage.second)
+        if (test->getParseError() == ParseError::NoError)
+          ++testCount;
+  progress.setRemaining(testCount * cfg.getExecutables().size() * cfg.getToolChains().size());
+
+  // The solution goes first when the other executables' steps are limited by
+  // its times.
+  std::vector<std::string> exeNames;
+  for (const auto& exePair : cfg.getExecutables())
+    exeNames.push_back(exePair.first);
+  const std::optional<std::string>& solution = cfg.getSolutionExecutable();
+  if (cfg.getStepTimes() && solution.has_value())
+    std::stable_partition(exeNames.begin(), exeNames.end(),
+                          [&](const std::string& name) { return name == *solution; });
+
   // Iterate over executables.
-  for (auto exePair : cfg.getExecutables()) {
+  for (const std::string& exeName : exeNames) {
     // Iterate over toolchains.
     for (auto& tcPair : cfg.getToolChains()) {
-      if (runTestsForToolChain(exePair.first, tcPair.first) == 1)
+      if (runTestsForToolChain(exeName, tcPair.first) == 1)
         failed = true;
     }
   }
+
+  if (cfg.getTimingHistoryPath().has_value())
+    cfg.getStepTimes()->save(*cfg.getTimingHistoryPath());
+
+  const std::shared_ptr<StepCache>& stepCache = cfg.getStepCache();
+  if (stepCache && stepCache->getHits() != 0)
+    std::cout << "Reused " << stepCache->getHits() << " outputs of steps shared by toolchains\n";
   return failed;
 }
 
@@ -35,31 +64,19 @@ std::string TestHarness::getTestInfo() const {
     }
   }
   oss << "Total Packages: " << testSet.size() << "\n";
+  if (cfg.getCpuLanes().isEnabled())
+    oss << "CPU lanes: " << cfg.getCpuLanes().getDescription() << "\n";
   return oss.str();
 }
 
-void TestHarness::printTestResult(const TestFile *test, TestResult result) {
-  std::cout << "    "
-            << (result.pass ? (Colors::GREEN + "[PASS]" + Colors::RESET)
-                            : (Colors::RED + "[FAIL]" + Colors::RESET))
-            << " " << std::setw(40) << std::left << test->getTestPath().stem().string();
-  if (cfg.isTimed()) {
-    double time = test->getElapsedTime();
-
-    if (time != 0) {
-      std::cout << std::fixed << std::setw(10) << std::setprecision(6)
-                << test->getElapsedTime() << "(s)";
-    }
-  }
-  std::cout << "\n";
-}
-
 bool TestHarness::runTestsForToolChain(std::string exeName, std::string tcName) {
   bool failed = false;
 
   ToolChain toolChain = cfg.getToolChain(tcName); // Get the toolchain to use.
   const fs::path& exe = cfg.getExecutablePath(exeName); // Set the toolchain's exe to be tested.
   toolChain.setTestedExecutable(exe);
+  toolChain.setMeasuresCounters(cfg.usesPerfCounters());
+  toolChain.setRecordsStepTimes(exeName == cfg.getSolutionExecutable());
 
   if (cfg.hasRuntime(exeName)) // If we have a runtime, set that as well.
     toolChain.setTestedRuntime(cfg.getRuntimePath(exeName));
@@ -69,6 +86,22 @@ bool TestHarness::runTestsForToolChain(std::string exeName, std::string tcName)
   std::cout << "\nTesting executable: " << exeName << " -> " << exe << '\n';
   std::cout << "With toolchain: " << tcName << " -> " << toolChain.getBriefDescription() << '\n';
 
+  // Each subpackage runs with the toolchain set up for its package. The
+  // pipeline runs the tests while the results are reported below in order.
+  std::vector<TestGroup> groups;
+  for (auto& [packageName, package] : testSet) {
+    toolChain.setTimingPolicy(cfg.getTimingPolicy(tcName, packageName));
+    toolChain.setCpuAffinity(cfg.getCpuAffinity(tcName, packageName));
+    for (auto& [subPackageName, subPackage] : package) {
+      TestGroup group{std::make_shared<ToolChain>(toolChain), {}};
+      for (const std::unique_ptr<TestFile>& test : subPackage)
+        if (test->getParseError() == ParseError::NoError)
+          group.tests.push_back(test.get());
+      groups.push_back(std::move(group));
+    }
+  }
+  TestPipeline pipeline(cfg, std::move(groups), progress);
+
   unsigned int toolChainCount = 0, toolChainPasses = 0; // Stat tracking for toolchain tests.
 
   // Iterate over each package.
@@ -86,9 +119,12 @@ bool TestHarness::runTestsForToolChain(std::string exeName, std::string tcName)
         std::unique_ptr<TestFile>& test = subPackage[i];
         if (test->getParseError() == ParseError::NoError) {
         
-          TestResult result = runTest(test.get(), toolChain, cfg);
+          JudgedTest judged = pipeline.takeResult();
+          const TestResult& result = judged.result;
+          std::cout << judged.log;
           results.addResult(exeName, tcName, subPackageName, result);
-          printTestResult(test.get(), result); 
+          reporter.testResult(test.get(), result);
+          progress.cellDone();
 
           if (result.pass) {
             ++packagePasses;
@@ -124,6 +160,9 @@ bool TestHarness::runTestsForToolChain(std::string exeName, std::string tcName)
   }
   std::cout << "\n";
 
+  if (cfg.showsPipelineStats())
+    std::cout << pipeline.getStatistics() << '\n';
+
   return failed;
 }
 
@@ -0,0 +1,330 @@
+#include "testharness/TestPipeline.h"
+
+#include "tests/TestRunning.h"
+#include "toolchain/Metrics.h"
+
+#include <iomanip>
+#include <optional>
+#include <sstream>
+
+#include <unistd.h>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Adds the time from its construction to its destruction to a total.
+class BusyTimer {
+public:
+  explicit BusyTimer(std::atomic<int64_t>& total) : total(total), start(Clock::now()) {}
+  ~BusyTimer() {
+    total += std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+  }
+
+private:
+  std::atomic<int64_t>& total;
+  Clock::time_point start;
+};
+
+} // End anonymous namespace
+
+namespace tester {
+
+// A test on its way through the pipeline.
+struct TestPipeline::Job {
+  size_t index;
+  TestFile* test;
+  std::shared_ptr<const ToolChain> toolChain;
+  fs::path scratchDir;
+
+  // Whether the test must run alone, or alone among timed tests.
+  bool exclusive{false}, timed{false};
+
+  std::optional<TestExecution> execution;
+  std::optional<TestResult> result;
+  std::string log;
+  std::exception_ptr error;
+};
+
+TestPipeline::TestPipeline(const Config& cfg, std::vector<TestGroup> groups,
+                           ProgressMonitor& progress)
+    : cfg(cfg), groups(std::move(groups)), progress(progress), runQueue(2 * cfg.getJobs()),
+      compareQueue(2 * cfg.getJobs()), window(4 * (cfg.getJobs() + cfg.getCompareJobs())),
+      start(Clock::now()), end(start), spawnersLeft(cfg.getJobs()) {
+
+  // Tests running at once each get a directory for their files. Without one
+  // they all run alone.
+  if (cfg.getJobs() > 1) {
+    static std::atomic<unsigned int> pipelines{0};
+    std::error_code ec;
+    scratchRoot = fs::temp_directory_path(ec) / ("tester_jobs_" + std::to_string(getpid()) +
+                                                 "_" + std::to_string(pipelines++));
+    if (!fs::create_directories(scratchRoot, ec))
+      scratchRoot.clear();
+  }
+
+  try {
+    threads.emplace_back(&TestPipeline::discover, this);
+    for (unsigned int i = 0; i < cfg.getJobs(); ++i)
+      threads.emplace_back(&TestPipeline::spawn, this);
+    for (unsigned int i = 0; i < cfg.getCompareJobs(); ++i)
+      threads.emplace_back(&TestPipeline::compare, this);
+  } catch (...) {
+    abort();
+    for (std::thread& thread : threads)
+      thread.join();
+    std::error_code ec;
+    if (!scratchRoot.empty())
+      fs::remove_all(scratchRoot, ec);
+    throw;
+  }
+}
+
+TestPipeline::~TestPipeline() {
+  abort();
+  for (std::thread& thread : threads)
+    if (thread.joinable())
+      thread.join();
+
+  std::error_code ec;
+  if (!scratchRoot.empty())
+    fs::remove_all(scratchRoot, ec);
+}
+
+void TestPipeline::discover() {
+  // Queue a test, waiting while it is too far ahead of the reporter. Returns
+  // false once the pipeline is stopped.
+  auto queue = [this](std::unique_ptr<Job> job, bool useScratch) {
+    {
+      std::unique_lock<std::mutex> lock(orderMutex);
+      reportedCv.wait(lock, [this]() { return queued < reported + window || aborted; });
+      if (aborted)
+        return false;
+      job->index = queued++;
+    }
+    if (useScratch) {
+      job->scratchDir = scratchRoot / std::to_string(job->index);
+      fs::create_directories(job->scratchDir);
+    }
+    bool pushed = runQueue.push(std::move(job));
+    updateQueueDepths();
+    return pushed;
+  };
+
+  try {
+    for (size_t group = 0; group < groups.size() && !aborted; ++group) {
+      const std::shared_ptr<ToolChain>& toolChain = groups[group].toolChain;
+      const std::vector<TestFile*>& tests = groups[group].tests;
+      bool useScratch = !scratchRoot.empty() && toolChain->isRelocatable();
+      bool timed = toolChain->getTimingPolicy().isStatistical();
+      bool exclusive =
+          (cfg.getJobs() > 1 && !useScratch) || (timed && !cfg.getCpuLanes().isEnabled());
+
+      // Without a directory of its own the group's batch writes over the
+      // files of the one before, so the tests queued before it finish first.
+      fs::path batchDir;
+      if (useScratch) {
+        batchDir = scratchRoot / ("batch" + std::to_string(group));
+        fs::create_directories(batchDir);
+      } else if (toolChain->isBatched()) {
+        std::unique_lock<std::mutex> lock(orderMutex);
+        reportedCv.wait(lock, [this]() { return reported == queued || aborted; });
+        if (aborted)
+          break;
+      }
+
+      // Compile the group's batch and read its expected outputs while the
+      // tests queued before it run.
+      {
+        BusyTimer busy(discoverNanos);
+        toolChain->prepareBatch(tests, batchDir);
+        for (TestFile* test : tests)
+          test->getExpectedOutput();
+      }
+
+      for (TestFile* test : tests) {
+        auto job = std::make_unique<Job>();
+        job->test = test;
+        job->toolChain = toolChain;
+        job->exclusive = exclusive;
+        job->timed = timed;
+        if (!queue(std::move(job), useScratch))
+          break;
+      }
+    }
+  } catch (...) {
+    std::lock_guard<std::mutex> lock(orderMutex);
+    discoveryError = std::current_exception();
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(orderMutex);
+    discoveryDone = true;
+  }
+  judgedCv.notify_all();
+  runQueue.close();
+}
+
+void TestPipeline::spawn() {
+  std::unique_ptr<Job> job;
+  while (runQueue.pop(job)) {
+    updateQueueDepths();
+    if (!aborted) {
+      try {
+        std::shared_lock<std::shared_mutex> shared(runLock, std::defer_lock);
+        std::unique_lock<std::shared_mutex> alone(runLock, std::defer_lock);
+        std::unique_lock<std::mutex> timed(timedLock, std::defer_lock);
+        if (job->exclusive)
+          alone.lock();
+        else
+          shared.lock();
+        if (job->timed && !job->exclusive)
+          timed.lock();
+        BusyTimer busy(spawnNanos);
+
+        Clock::time_point began = Clock::now();
+        progress.testStarted();
+        Metrics::get().countTestStarted();
+        try {
+          job->execution = executeTest(job->test, *job->toolChain, job->scratchDir);
+        } catch (...) {
+          progress.testFinished(std::chrono::duration<double>(Clock::now() - began).count(), false);
+          throw;
+        }
+        progress.testFinished(std::chrono::duration<double>(Clock::now() - began).count(),
+                              job->execution->timedOut);
+
+        // Without a scratch directory the next test overwrites the files.
+        if (job->scratchDir.empty())
+          judge(*job);
+      } catch (...) {
+        job->error = std::current_exception();
+      }
+    }
+    compareQueue.push(std::move(job));
+    updateQueueDepths();
+  }
+
+  if (--spawnersLeft == 0)
+    compareQueue.close();
+}
+
+void TestPipeline::compare() {
+  std::unique_ptr<Job> job;
+  while (compareQueue.pop(job)) {
+    updateQueueDepths();
+    if (!aborted && job->execution.has_value() && !job->result.has_value()) {
+      BusyTimer busy(compareNanos);
+      try {
+        judge(*job);
+      } catch (...) {
+        job->error = std::current_exception();
+      }
+    }
+
+    std::error_code ec;
+    if (!job->scratchDir.empty())
+      fs::remove_all(job->scratchDir, ec);
+    finish(std::move(job));
+  }
+}
+
+void TestPipeline::judge(Job& job) {
+  Clock::time_point began = Clock::now();
+  std::ostringstream log;
+  job.result.emplace(judgeTest(job.test, *job.toolChain, *job.execution, cfg, log));
+  job.log = log.str();
+
+  Metrics& metrics = Metrics::get();
+  metrics.observeCompare(std::chrono::duration<double>(Clock::now() - began).count());
+  metrics.countTestJudged(job.result->pass, job.execution->timedOut);
+}
+
+void TestPipeline::updateQueueDepths() {
+  Metrics::get().setQueueDepths(runQueue.size(), compareQueue.size());
+}
+
+void TestPipeline::finish(std::unique_ptr<Job> job) {
+  {
+    std::lock_guard<std::mutex> lock(orderMutex);
+    size_t index = job->index;
+    judged.emplace(index, std::move(job));
+    maxReorder = std::max(maxReorder, judged.size());
+  }
+  judgedCv.notify_all();
+}
+
+void TestPipeline::abort() {
+  {
+    std::lock_guard<std::mutex> lock(orderMutex);
+    aborted = true;
+  }
+  reportedCv.notify_all();
+  judgedCv.notify_all();
+  runQueue.close();
+}
+
+JudgedTest TestPipeline::takeResult() {
+  std::unique_ptr<Job> job;
+  {
+    std::unique_lock<std::mutex> lock(orderMutex);
+    Clock::time_point waitStart = Clock::now();
+    judgedCv.wait(lock, [this]() {
+      return aborted || judged.count(reported) != 0 || (discoveryDone && reported == queued);
+    });
+    reportWait += Clock::now() - waitStart;
+
+    if (aborted)
+      throw std::runtime_error("The test pipeline was stopped.");
+    auto next = judged.find(reported);
+    if (next == judged.end()) {
+      if (discoveryError)
+        std::rethrow_exception(discoveryError);
+      throw std::runtime_error("No tests are left in the pipeline.");
+    }
+    job = std::move(next->second);
+    judged.erase(next);
+    ++reported;
+    end = Clock::now();
+  }
+  reportedCv.notify_all();
+
+  if (job->error) {
+    abort();
+    std::rethrow_exception(job->error);
+  }
+  return JudgedTest{std::move(*job->result), std::move(job->log)};
+}
+
+std::string TestPipeline::getStatistics() const {
+  double wall = std::chrono::duration<double>(end - start).count();
+  std::ostringstream oss;
+  oss << std::fixed << std::setprecision(2);
+
+  auto stage = [&](const std::string& name, unsigned int count, double busySeconds) {
+    oss << "  " << std::left << std::setw(15) << name << std::right << std::setw(3) << count
+        << (count == 1 ? " thread   busy " : " threads  busy ") << std::setw(6)
+        << (wall > 0 ? 100 * busySeconds / (wall * count) : 0) << "%\n";
+  };
+  auto queue = [&](const std::string& name, const QueueStats& stats) {
+    oss << "  " << std::left << std::setw(15) << name << std::right << "capacity "
+        << stats.capacity << ", mean depth " << stats.meanDepth << ", max " << stats.maxDepth
+        << ", full for " << stats.fullSeconds << "s, empty for " << stats.emptySeconds << "s\n";
+  };
+
+  oss << "Pipeline: " << reported << " tests in " << wall << "s";
+  if (wall > 0)
+    oss << " (" << reported / wall << " tests/s)";
+  oss << '\n';
+  stage("discovery", 1, discoverNanos / 1e9);
+  queue("run queue", runQueue.getStats());
+  stage("spawn", cfg.getJobs(), spawnNanos / 1e9);
+  queue("compare queue", compareQueue.getStats());
+  stage("compare", cfg.getCompareJobs(), compareNanos / 1e9);
+  oss << "  " << std::left << std::setw(15) << "reorder buffer" << std::right << "max "
+      << maxReorder << " of a window of " << window << '\n';
+  stage("report", 1, wall - std::chrono::duration<double>(reportWait).count());
+  return oss.str();
+}
+
+} // End namespace tester
@@ -0,0 +1,207 @@
+#include "tests/Diff.h"
+
+#include "Colors.h"
+#include "Hash.h"
+
+#include <algorithm>
+
+namespace {
+
+enum class Op { Equal, Delete, Insert };
+
+// One step of the edit script. Equal lines are in both texts, deleted lines
+// only in the expected text and inserted lines only in the generated one.
+struct Edit {
+  Op op;
+  size_t expected, generated;
+};
+
+std::string_view getLine(std::string_view text, const tester::LineIndex& lines, size_t i) {
+  size_t start = i == 0 ? 0 : lines.ends[i - 1];
+  return text.substr(start, lines.ends[i] - start);
+}
+
+// Myers' greedy algorithm over a[aBegin, aEnd) and b[bBegin, bEnd), appending
+// the edit script to `edits`. Returns false, without touching `edits`, if the
+// script needs more than `maxEdits` inserts and deletes. Remembering where
+// every diagonal got to costs O(D^2) memory, which bounding D keeps small.
+bool myersDiff(const std::vector<uint64_t>& a, size_t aBegin, size_t aEnd,
+               const std::vector<uint64_t>& b, size_t bBegin, size_t bEnd, size_t maxEdits,
+               std::vector<Edit>& edits) {
+  long n = aEnd - aBegin, m = bEnd - bBegin;
+  long maxD = std::min<long>(n + m, maxEdits);
+  long offset = maxD + 1;
+  std::vector<long> v(2 * maxD + 3, 0);
+
+  // trace[d] holds v for diagonals -d..d as it was before step d.
+  std::vector<std::vector<long>> trace;
+  long found = -1;
+  for (long d = 0; d <= maxD && found < 0; ++d) {
+    trace.emplace_back(v.begin() + offset - d, v.begin() + offset + d + 1);
+    for (long k = -d; k <= d; k += 2) {
+      long x = k == -d || (k != d && v[offset + k - 1] < v[offset + k + 1])
+                   ? v[offset + k + 1]
+                   : v[offset + k - 1] + 1;
+      long y = x - k;
+      while (x < n && y < m && a[aBegin + x] == b[bBegin + y]) {
+        ++x;
+        ++y;
+      }
+      v[offset + k] = x;
+      if (x >= n && y >= m) {
+        found = d;
+        break;
+      }
+    }
+  }
+  if (found < 0)
+    return false;
+
+  // Walk back from the end, one edit per step, collecting the script in reverse.
+  std::vector<Edit> reversed;
+  long x = n, y = m;
+  for (long d = found; d > 0; --d) {
+    const std::vector<long>& prev = trace[d];
+    long k = x - y;
+    long prevK = k == -d || (k != d && prev[k - 1 + d] < prev[k + 1 + d]) ? k + 1 : k - 1;
+    long prevX = prev[prevK + d], prevY = prevX - prevK;
+    for (; x > prevX && y > prevY; --x, --y)
+      reversed.push_back({Op::Equal, aBegin + x - 1, bBegin + y - 1});
+    if (x == prevX)
+      reversed.push_back({Op::Insert, 0, bBegin + prevY});
+    else
+      reversed.push_back({Op::Delete, aBegin + prevX, 0});
+    x = prevX;
+    y = prevY;
+  }
+  for (; x > 0 && y > 0; --x, --y)
+    reversed.push_back({Op::Equal, aBegin + x - 1, bBegin + y - 1});
+
+  edits.insert(edits.end(), reversed.rbegin(), reversed.rend());
+  return true;
+}
+
+void renderLine(std::string& out, char mark, std::string_view line) {
+  bool newline = !line.empty() && line.back() == '\n';
+  if (newline)
+    line.remove_suffix(1);
+
+  if (mark == '-')
+    out += Colors::RED;
+  else if (mark == '+')
+    out += Colors::GREEN;
+  out += mark;
+  out += line;
+  if (mark != ' ')
+    out += Colors::RESET;
+  out += '\n';
+
+  // Otherwise a missing final newline would be invisible.
+  if (!newline)
+    out += "\\ No newline at end of file\n";
+}
+
+} // End anonymous namespace
+
+namespace tester {
+
+LineIndex indexLines(std::string_view text) {
+  LineIndex index;
+  size_t start = 0;
+  while (start < text.size()) {
+    size_t newline = text.find('\n', start);
+    size_t end = newline == std::string_view::npos ? text.size() : newline + 1;
+    Fnv1a hash;
+    hash.add(text.substr(start, end - start));
+    index.ends.push_back(end);
+    index.hashes.push_back(hash.get());
+    start = end;
+  }
+  return index;
+}
+
+std::string renderDiff(std::string_view expected, const LineIndex& expectedLines,
+                       std::string_view generated, const LineIndex& generatedLines,
+                       const DiffOptions& options) {
+  const std::vector<uint64_t>& a = expectedLines.hashes;
+  const std::vector<uint64_t>& b = generatedLines.hashes;
+
+  // Outputs usually differ in a few places, so only diff what lies between
+  // the common prefix and suffix.
+  size_t prefix = 0;
+  while (prefix < a.size() && prefix < b.size() && a[prefix] == b[prefix])
+    ++prefix;
+  size_t suffix = 0;
+  while (suffix < a.size() - prefix && suffix < b.size() - prefix &&
+         a[a.size() - 1 - suffix] == b[b.size() - 1 - suffix])
+    ++suffix;
+
+  std::vector<Edit> edits;
+  for (size_t i = 0; i < prefix; ++i)
+    edits.push_back({Op::Equal, i, i});
+
+  std::string out;
+  size_t aEnd = a.size() - suffix, bEnd = b.size() - suffix;
+  if (myersDiff(a, prefix, aEnd, b, prefix, bEnd, options.maxEdits, edits)) {
+    for (size_t i = 0; i < suffix; ++i)
+      edits.push_back({Op::Equal, aEnd + i, bEnd + i});
+  } else {
+    // Diff just the start of what differs instead, which always fits.
+    out += "More than " + std::to_string(options.maxEdits) +
+           " lines differ, only the start of the differences is shown.\n";
+    size_t window = options.maxEdits / 2;
+    myersDiff(a, prefix, std::min(aEnd, prefix + window), b, prefix,
+              std::min(bEnd, prefix + window), options.maxEdits, edits);
+  }
+
+  // Changes less than two contexts apart share a hunk.
+  size_t hunks = 0, i = 0;
+  while (i < edits.size()) {
+    while (i < edits.size() && edits[i].op == Op::Equal)
+      ++i;
+    if (i == edits.size())
+      break;
+    if (hunks++ == options.maxHunks) {
+      out += "... more changes not shown\n";
+      break;
+    }
+
+    size_t start = i - std::min(i, options.context), end = i;
+    while (end < edits.size()) {
+      size_t equal = end;
+      while (equal < edits.size() && edits[equal].op == Op::Equal)
+        ++equal;
+      if (equal != end && (equal == edits.size() || equal - end > 2 * options.context))
+        break;
+      end = equal + (equal < edits.size());
+    }
+    size_t stop = std::min(edits.size(), end + options.context);
+
+    // Line numbers count from one, like in unified diffs a side without lines
+    // in the hunk names the line before it.
+    size_t expBefore = 0, genBefore = 0, expCount = 0, genCount = 0;
+    for (size_t j = 0; j < stop; ++j) {
+      size_t& exp = j < start ? expBefore : expCount;
+      size_t& gen = j < start ? genBefore : genCount;
+      exp += edits[j].op != Op::Insert;
+      gen += edits[j].op != Op::Delete;
+    }
+    out += "@@ -" + std::to_string(expBefore + (expCount != 0)) + "," + std::to_string(expCount) +
+           " +" + std::to_string(genBefore + (genCount != 0)) + "," + std::to_string(genCount) +
+           " @@\n";
+
+    for (size_t j = start; j < stop; ++j) {
+      const Edit& edit = edits[j];
+      if (edit.op == Op::Equal)
+        renderLine(out, ' ', getLine(expected, expectedLines, edit.expected));
+      else if (edit.op == Op::Delete)
+        renderLine(out, '-', getLine(expected, expectedLines, edit.expected));
+      else
+        renderLine(out, '+', getLine(generated, generatedLines, edit.generated));
+    }
+    i = stop;
+  }
+  return out;
+}
+
+} // End namespace tester
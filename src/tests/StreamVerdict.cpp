@@ -0,0 +1,30 @@
+#include "tests/StreamVerdict.h"
+
+#include "tests/TestRunning.h"
+
+namespace tester {
+
+bool StreamVerdict::consume(std::string_view chunk) {
+  if (!firstLineDone) {
+    size_t newline = chunk.find('\n');
+    firstLine += chunk.substr(0, newline);
+    firstLineDone = newline != std::string_view::npos;
+  }
+
+  if (!mismatched) {
+    const std::string& contents = expected.contents;
+    mismatched = seen + chunk.size() > contents.size() ||
+                 contents.compare(seen, chunk.size(), chunk) != 0;
+  }
+  seen += chunk.size();
+  if (!mismatched)
+    return true;
+
+  // Like judgeTest, fall back to comparing error strings. That is only decided
+  // once the whole first line has arrived.
+  if (!expected.errorString.has_value())
+    return false;
+  return !firstLineDone || getErrorString(firstLine) == expected.errorString;
+}
+
+} // End namespace tester
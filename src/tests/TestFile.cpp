@@ -1,5 +1,9 @@
 #include "tests/TestFile.h"
+#include "Hash.h"
 #include "tests/TestParser.h"
+#include "tests/TestRunning.h"
+
+#include <iterator>
 
 namespace {
 
@@ -39,6 +43,21 @@ TestFile::~TestFile() {
   }
 }
 
+const ExpectedOutput& TestFile::getExpectedOutput() const {
+  std::call_once(expectedLoaded, [this]() {
+    std::ifstream file(outPath, std::ios::binary);
+    std::string contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    Fnv1a hash;
+    hash.add(contents);
+    LineIndex lines = indexLines(contents);
+    std::optional<std::string> errorString = getErrorString(contents);
+    expectedOutput = std::make_unique<const ExpectedOutput>(
+        ExpectedOutput{std::move(contents), std::move(lines), hash.get(), std::move(errorString)});
+  });
+  return *expectedOutput;
+}
+
 std::string TestFile::getParseErrorMsg() const {
 
   switch (getParseError()) {
@@ -57,6 +76,9 @@ std::string TestFile::getParseErrorMsg() const {
       return "An unexpected runtime error occured while parsing the "
              "testifle.";
       break;
+    case ParseError::InvalidDirectiveValue:
+      return errorMsg;
+      break;
     default:
       return "No matching Parse Error";
   }
@@ -1,5 +1,10 @@
 #include "tests/TestParser.h"
 
+#include <cctype>
+#include <cmath>
+#include <sstream>
+#include <utility>
+
 namespace tester {
 
 /**
@@ -14,6 +19,13 @@ bool fullyContains(const std::string& str, const std::string& substr) {
   return str.substr(pos, substr.length()) == substr;
 }
 
+std::string TestParser::parseValueFromLine(const std::string& line,
+                                           const std::string& directive) {
+  std::string value = line.substr(line.find(directive) + directive.length());
+  size_t start = value.find_first_not_of(" \t"), end = value.find_last_not_of(" \t\r");
+  return start == std::string::npos ? "" : value.substr(start, end - start + 1);
+}
+
 void TestParser::insLineToFile(fs::path filePath, std::string line, bool firstInsert) {
   // open in append mode since otherwise multi-line checks and inputs would
   // over-write themselves.
@@ -80,7 +92,7 @@ ParseError TestParser::matchCheckDirective(std::string& line) {
 
   if (!fullyContains(line, Directive::CHECK))
     return ParseError::NoError;
-  if (foundCheckFile)
+  if (foundCheckFile || foundCheckHash)
     return ParseError::DirectiveConflict;
 
   size_t findIdx = line.find(Directive::CHECK);
@@ -124,7 +136,7 @@ ParseError TestParser::matchCheckFileDirective(std::string& line) {
 
   if (!fullyContains(line, Directive::CHECK_FILE))
     return ParseError::NoError;
-  if (foundCheck)
+  if (foundCheck || foundCheckHash)
     return ParseError::DirectiveConflict;
 
   PathOrError pathOrError = parsePathFromLine(line, Directive::CHECK_FILE);
@@ -137,25 +149,187 @@ ParseError TestParser::matchCheckFileDirective(std::string& line) {
   return std::get<ParseError>(pathOrError);
 }
 
+/**
+ * @param directive the directive whose value is rejected
+ * @param reason what is wrong with the value
+ * @returns InvalidDirectiveValue, with a message naming the directive
+ */
+ParseError TestParser::invalidValue(const std::string& directive, const std::string& reason) {
+  invalidValueMsg = "Invalid " + directive.substr(0, directive.size() - 1) + " directive: " +
+                    reason;
+  return ParseError::InvalidDirectiveValue;
+}
+
+/**
+ * @param line the line from testfile being parsed
+ * @returns An error state describing the error, if one exists
+ */
+ParseError TestParser::matchCheckHashDirective(std::string& line) {
+
+  if (!fullyContains(line, Directive::CHECK_HASH))
+    return ParseError::NoError;
+  if (foundCheck || foundCheckFile || foundCheckHash || foundComparator)
+    return ParseError::DirectiveConflict;
+
+  // The SHA-256 of the output in hex, its length in bytes and optionally a
+  // reference copy of it, like CHECK_HASH: 9f86...0f08 4 ./out-stream/big.out
+  std::istringstream fields(parseValueFromLine(line, Directive::CHECK_HASH));
+  std::string hex, size, reference;
+  if (!(fields >> hex >> size) || hex.size() != 64 ||
+      hex.find_first_not_of("0123456789abcdefABCDEF") != std::string::npos ||
+      size.find_first_not_of("0123456789") != std::string::npos)
+    return invalidValue(Directive::CHECK_HASH,
+                        "expected a SHA-256 in hex followed by a size in bytes.");
+  std::getline(fields >> std::ws, reference);
+
+  ExpectedHash expected;
+  for (size_t i = 0; i < expected.digest.size(); ++i)
+    expected.digest[i] = static_cast<uint8_t>(std::stoul(hex.substr(2 * i, 2), nullptr, 16));
+  try {
+    expected.size = std::stoull(size);
+  } catch (const std::exception&) {
+    return invalidValue(Directive::CHECK_HASH,
+                        "expected a SHA-256 in hex followed by a size in bytes.");
+  }
+
+  // The reference is optional, a test tree may leave it out to stay small.
+  if (!reference.empty()) {
+    fs::path relPath = (testfile->getTestPath().parent_path() / reference).lexically_normal();
+    if (fs::exists(reference))
+      expected.reference = reference;
+    else if (fs::exists(relPath))
+      expected.reference = relPath;
+  }
+
+  testfile->setExpectedHash(std::move(expected));
+  foundCheckHash = true;
+  return ParseError::NoError;
+}
+
+/**
+ * @param line the line from testfile being parsed
+ * @returns An error state describing the error, if one exists
+ */
+ParseError TestParser::matchComparatorDirective(std::string& line) {
+
+  if (!fullyContains(line, Directive::COMPARATOR))
+    return ParseError::NoError;
+  if (foundComparator || foundCheckHash)
+    return ParseError::DirectiveConflict;
+
+  std::string spec = parseValueFromLine(line, Directive::COMPARATOR);
+  try {
+    testfile->setComparator(Comparator::create(spec));
+  } catch (const std::runtime_error& e) {
+    return invalidValue(Directive::COMPARATOR, e.what());
+  }
+
+  foundComparator = true;
+  return ParseError::NoError;
+}
+
+/**
+ * @param line the line from testfile being parsed
+ * @returns An error state describing the error, if one exists
+ */
+ParseError TestParser::matchTimeoutDirective(std::string& line) {
+
+  if (!fullyContains(line, Directive::TIMEOUT))
+    return ParseError::NoError;
+  if (foundTimeout)
+    return ParseError::DirectiveConflict;
+
+  // A positive number of seconds, like TIMEOUT: 2.5
+  std::string value = parseValueFromLine(line, Directive::TIMEOUT);
+  std::string reason = "'" + value + "' is not a positive number of seconds.";
+  size_t used = 0;
+  double seconds = 0;
+  try {
+    seconds = std::stod(value, &used);
+  } catch (const std::exception&) {
+    return invalidValue(Directive::TIMEOUT, reason);
+  }
+  if (used != value.size() || !std::isfinite(seconds) || seconds <= 0)
+    return invalidValue(Directive::TIMEOUT, reason);
+
+  testfile->setTimeout(seconds);
+  foundTimeout = true;
+  return ParseError::NoError;
+}
+
+/**
+ * @param line the line from testfile being parsed
+ * @returns An error state describing the error, if one exists
+ */
+ParseError TestParser::matchMemoryDirective(std::string& line) {
+
+  if (!fullyContains(line, Directive::MEMORY))
+    return ParseError::NoError;
+  if (foundMemory)
+    return ParseError::DirectiveConflict;
+
+  // A positive number of bytes with an optional K, M or G suffix, like MEMORY: 512M
+  std::string value = parseValueFromLine(line, Directive::MEMORY);
+  std::string reason = "'" + value + "' is not a positive number of bytes with an optional K, M "
+                       "or G suffix.";
+  if (value.empty() || !std::isdigit(static_cast<unsigned char>(value.front())))
+    return invalidValue(Directive::MEMORY, reason);
+  size_t used = 0;
+  uint64_t bytes = 0;
+  try {
+    bytes = std::stoull(value, &used);
+  } catch (const std::exception&) {
+    return invalidValue(Directive::MEMORY, reason);
+  }
+  std::string suffix = value.substr(used);
+  unsigned int shift = suffix.empty() ? 0 : suffix == "K" ? 10 : suffix == "M" ? 20
+                     : suffix == "G" ? 30 : 64;
+  if (shift == 64 || bytes == 0 || bytes > (UINT64_MAX >> shift))
+    return invalidValue(Directive::MEMORY, reason);
+
+  testfile->setMemoryLimit(bytes << shift);
+  foundMemory = true;
+  return ParseError::NoError;
+}
+
 /**
  * @brief for each line in the testfile, attempt to parse and match one of the
  * several directives. Should only be called if the parser knows we are in a
- * comment.
+ * comment. A line holds one directive, so the text of an INPUT or CHECK can
+ * mention another one.
  */
 ParseError TestParser::matchDirectives(std::string& line) {
-  ParseError error;
-
-  // Look for each of 4 directives
-  if ((error = matchInputDirective(line)) != ParseError::NoError)
-    return error;
-  if ((error = matchCheckDirective(line)) != ParseError::NoError)
-    return error;
-  if ((error = matchInputFileDirective(line)) != ParseError::NoError)
-    return error;
-  if ((error = matchCheckFileDirective(line)) != ParseError::NoError)
-    return error;
-
-  return ParseError::NoError;
+  typedef ParseError (TestParser::*Matcher)(std::string&);
+
+  // Directives that take a value only count at the start of the comment.
+  const std::pair<const std::string&, Matcher> leading[] = {
+    {Directive::TIMEOUT, &TestParser::matchTimeoutDirective},
+    {Directive::MEMORY, &TestParser::matchMemoryDirective},
+    {Directive::COMPARATOR, &TestParser::matchComparatorDirective},
+    {Directive::CHECK_HASH, &TestParser::matchCheckHashDirective}
+  };
+  size_t start = line.find_first_not_of(" \t");
+  for (const auto& [directive, match] : leading)
+    if (start != std::string::npos && line.compare(start, directive.size(), directive) == 0)
+      return (this->*match)(line);
+
+  // Otherwise the first of the others in the line.
+  const std::pair<const std::string&, Matcher> anywhere[] = {
+    {Directive::INPUT, &TestParser::matchInputDirective},
+    {Directive::CHECK, &TestParser::matchCheckDirective},
+    {Directive::INPUT_FILE, &TestParser::matchInputFileDirective},
+    {Directive::CHECK_FILE, &TestParser::matchCheckFileDirective}
+  };
+  size_t first = std::string::npos;
+  Matcher match = nullptr;
+  for (const auto& [directive, matcher] : anywhere) {
+    size_t pos = line.find(directive);
+    if (pos < first) {
+      first = pos;
+      match = matcher;
+    }
+  }
+  return match ? (this->*match)(line) : ParseError::NoError;
 }
 
 /**
@@ -218,7 +392,8 @@ void TestParser::parse() {
       ParseError error = matchDirectives(line);
       if (error != ParseError::NoError) {
         testfile->getParseError(error);
-        testfile->setParseErrorMsg("Generic Error");
+        bool badValue = error == ParseError::InvalidDirectiveValue;
+        testfile->setParseErrorMsg(badValue ? invalidValueMsg : "Generic Error");
         break;
       }
     }
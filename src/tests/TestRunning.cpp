@@ -1,131 +1,138 @@
 #include "tests/TestRunning.h"
 
 #include "Colors.h"
+#include "Hash.h"
 #include "config/Config.h"
-#include "dtl/dtl.hpp"
+#include "tests/Diff.h"
+#include "tests/StreamVerdict.h"
 #include "tests/TestResult.h"
 #include "toolchain/CommandException.h"
 #include "toolchain/ExecutionState.h"
+#include <algorithm>
 #include <optional>
 #include <fstream>
-#include <sstream>
-#include <tuple>
+#include <iterator>
+#include <vector>
 
 namespace {
 
+// Bytes read at a time from outputs that are only hashed or scanned.
+constexpr size_t CHUNK_BYTES = 1 << 16;
+
 /**
- * @brief Open up a file and print char by char to stdout. To increase the
+ * @brief Open up a file and print it to `out`. To increase the
  * visibility of spaces (which can cause sneaky diffs on testcases) we print
  * them as asterisks instead.
  */
-void dumpFile(const fs::path& filePath, bool showSpace = false) {
+void dumpFile(std::ostream& out, const fs::path& filePath, bool showSpace = false) {
   std::ifstream file(filePath);
   if (!file.is_open()) {
     std::cerr << "Error opening file: " << filePath << std::endl;
     return;
   }
-  char ch;
-  bool lastCharIsNl = false;
-  while (file.get(ch)) {
-    if (ch == ' ' && showSpace) {
-      std::cout << '*';
-    } else {
-      std::cout << ch;
-    }
-    lastCharIsNl = (ch == '\n');
-  }
-  if (!lastCharIsNl) {
-    std::cout << Colors::BG_WHITE << Colors::BLACK << '%' << Colors::RESET << std::endl;
+  // Read it whole and write it at once rather than a character at a time.
+  std::string contents(std::istreambuf_iterator<char>(file), {});
+  if (showSpace)
+    std::replace(contents.begin(), contents.end(), ' ', '*');
+  out << contents;
+  if (contents.empty() || contents.back() != '\n') {
+    out << Colors::BG_WHITE << Colors::BLACK << '%' << Colors::RESET << std::endl;
   }
   file.close();
 }
 
+void formatFileDump(std::ostream& out, const fs::path& testPath, const fs::path& expOutPath,
+                    const fs::path& genOutPath) {
+  out << "----- TestFile: "<< testPath.filename() << std::endl;
+  dumpFile(out, testPath);
+  out << "----- Expected Output (" << fs::file_size(expOutPath) << " bytes)" << std::endl;
+  dumpFile(out, expOutPath, true);
+  out << "----- Generated Output (" << fs::file_size(genOutPath) << " bytes)" << std::endl;
+  dumpFile(out, genOutPath, true);
+  out << "-----------------------" << std::endl;
+}
+
 /**
- * @brief Read a file character by character. Produce a vector of strings where
- * each string corresponds to a single line in the file until the newline and
- * each newline gets its own elmenet in the vector. This helps us differentiate
- * between two files where one only one is newline terminated by comparing the sizes
- * of the vectors.  
+ * @brief The offset of the first byte two files differ at, reading both a
+ * chunk at a time. Nothing if they are the same or can't be opened.
  */
-std::vector<std::string> readFileWithNewlines(const fs::path& filepath) {
+std::optional<uint64_t> findFirstDifference(const fs::path& file1, const fs::path& file2) {
+  std::ifstream in1(file1, std::ios::binary), in2(file2, std::ios::binary);
+  if (!in1.is_open() || !in2.is_open())
+    return std::nullopt;
 
-  std::ifstream file(filepath);
-  std::vector<std::string> lines;
-  if (!file.is_open()) {
-    throw std::runtime_error("Failed to open file.");
+  std::vector<char> buffer1(CHUNK_BYTES), buffer2(CHUNK_BYTES);
+  uint64_t offset = 0;
+  while (true) {
+    in1.read(buffer1.data(), static_cast<std::streamsize>(buffer1.size()));
+    in2.read(buffer2.data(), static_cast<std::streamsize>(buffer2.size()));
+    size_t read1 = static_cast<size_t>(in1.gcount()), read2 = static_cast<size_t>(in2.gcount());
+    size_t common = std::min(read1, read2);
+    size_t same = static_cast<size_t>(
+        std::mismatch(buffer1.begin(), buffer1.begin() + common, buffer2.begin()).first -
+        buffer1.begin());
+    if (same < common || read1 != read2)
+      return offset + same;
+    if (read1 == 0)
+      return std::nullopt;
+    offset += read1;
   }
+}
 
-  std::string currentLine;
-  char ch;
-  while (file.get(ch)) {
-    if (ch == '\n') {
-      lines.push_back(currentLine);
-      lines.push_back("\n"); // push newline as a separate string
-      currentLine.clear();
-    } else {
-      currentLine += ch;
+/**
+ * @brief Judge an output by the digest a CHECK_HASH directive gave. There is
+ * nothing to diff, so a mismatch is described by its length and digest, and by
+ * where it first differs if a reference copy of the expected output is at hand.
+ */
+tester::TestResult judgeHashedTest(const tester::TestFile* test, const fs::path& genOutPath,
+                                   int verbosity, std::ostream& log) {
+  const tester::ExpectedHash& expected = *test->getExpectedHash();
+  tester::Sha256::Digest digest;
+  uint64_t size = 0;
+  if (!tester::hashFile(genOutPath, digest, size))
+    return tester::TestResult(test->getTestPath(), false, true, "Failed to create output file");
+
+  bool pass = size == expected.size && digest == expected.digest;
+  if (verbosity == 3 || (verbosity > 0 && !pass)) {
+    log << "Generated output is " << size << " bytes with SHA-256 "
+        << tester::Sha256::toHex(digest) << ", expected " << expected.size << " bytes with "
+        << tester::Sha256::toHex(expected.digest) << '\n';
+    if (!pass && !expected.reference.empty()) {
+      std::optional<uint64_t> offset = findFirstDifference(expected.reference, genOutPath);
+      if (offset.has_value())
+        log << "First difference at byte offset " << *offset << " of " << expected.reference
+            << '\n';
+      else
+        log << "Same as " << expected.reference << ", which doesn't match the digest\n";
     }
   }
-  if (!currentLine.empty() || (file.eof() && ch == '\n')) {
-    lines.push_back(currentLine);
-  }
-  return lines;
+  return tester::TestResult(test->getTestPath(), pass, false, "",
+                            {pass ? tester::OutputMatch::Exact : tester::OutputMatch::Mismatch});
 }
 
 /**
- * @brief a precise character by character diff between two files.
- * 
- * @param genFile file path with generated output of final toolchain step
- * @param expFile file path with expected output for the testcase. 
- * @returns a pair with 1) isDiff boolean and 2) diff string (empty if isDiff is false)
+ * @brief The comparator a test is judged by, its own or else its toolchain's.
  */
-std::pair<bool, std::string> preciseDiff(const fs::path& file1, const fs::path& file2) {
-
-  std::vector<std::string> lines1;
-  std::vector<std::string> lines2;
-  bool isDiff = false; // do the files have any difference
+const tester::Comparator& getComparator(const tester::TestFile* test,
+                                        const tester::ToolChain& toolChain) {
+  return test->getComparator() ? *test->getComparator() : toolChain.getComparator();
+}
 
-  try {
-    lines1 = readFileWithNewlines(file1);
-    lines2 = readFileWithNewlines(file2);
-  } catch (const std::runtime_error& e) {
-    return std::make_pair(false, "");
-  }
+} // end anonymous namespace
 
-  dtl::Diff<std::string> diff(lines1, lines2);
-  diff.compose();
-  dtl::Ses<std::string> ses = diff.getSes();
-
-  std::string diffStr = std::string();
-  for (const auto& sesElem : ses.getSequence()) {
-    if (sesElem.second.type != dtl::SES_COMMON) {
-      if (sesElem.second.type == dtl::SES_ADD) {
-        diffStr += Colors::RED + "-" + sesElem.first + Colors::RESET + "\n";
-      } else {
-        diffStr += Colors::GREEN + "+" + sesElem.first + Colors::RESET + "\n";
-      }
-      isDiff = true;
-    }
-  }
-  return std::make_pair(isDiff, std::move(diffStr));
-}
+namespace tester {
 
 /**
- * @brief: Given a file path, return the substring of the first line that conforms to
- * the error testcase specification.
+ * @brief: Given the contents of an output, return the substring of the first
+ * line that conforms to the error testcase specification.
  */
-std::optional<std::string >getErrorString(const fs::path outPath) {
-
-  std::ifstream ins(outPath); // open input file stream of output file of toolchain
-  if (!ins.is_open()) {
-    throw std::runtime_error("Failed to open the generated output file of the toolchain.");
-  }
+std::optional<std::string> getErrorString(std::string_view output) {
 
-  std::string firstLine;
-  if (!getline(ins, firstLine)) {
-    // can't get the first line for some reason.
+  if (output.empty()) {
+    // there is no first line.
     return std::nullopt;
   }
+  std::string_view firstLine = output.substr(0, output.find('\n'));
 
   size_t errorStart = firstLine.find("Error");
   if (errorStart == std::string::npos) {
@@ -133,56 +140,58 @@ std::optional<std::string >getErrorString(const fs::path outPath) {
     return std::nullopt;
   }
 
-  std::string snipLHS = firstLine.substr(errorStart);
   // Generated outputs may have implementation defined message on the RHS of
   // a colon for an error output. If a colon exists, strip what it and what is on
   // the RHS of it.
-  size_t colonPos = snipLHS.find(":");
-  if (colonPos == std::string::npos) {
-    return snipLHS;
-  }
-  // colon in output
-  std::string snipRHS = snipLHS.substr(0, colonPos);
-  return snipRHS;
-}
-
-void formatFileDump(const fs::path& testPath, const fs::path& expOutPath,
-                    const fs::path& genOutPath) {
-  std::cout << "----- TestFile: "<< testPath.filename() << std::endl;
-  dumpFile(testPath);
-  std::cout << "----- Expected Output (" << fs::file_size(expOutPath) << " bytes)" << std::endl;
-  dumpFile(expOutPath, true);
-  std::cout << "----- Generated Output (" << fs::file_size(genOutPath) << " bytes)" << std::endl;
-  dumpFile(genOutPath, true);
-  std::cout << "-----------------------" << std::endl;
+  std::string_view snipLHS = firstLine.substr(errorStart);
+  return std::string(snipLHS.substr(0, snipLHS.find(':')));
 }
 
 /**
- * @brief custom diff implementation which corresponds to how we compare an error testcase
- * in the spec. Currently, we look for the first line in the generated output and match
- * if the expected output is a full substring, up to the first colon.
- * 
- * @param genFile path to the file containing generated output of final toolchain step
- * @param expFile path to the file containing expected output for the testcase. 
- * @returns pair indicating 1) success and 2) diff in case of failure
+ * @brief Compare a generated output to an expected output with a comparator,
+ * which also locates the first difference of a mismatch. Mismatching outputs
+ * still match as an error test if the error strings of their first lines agree.
  */
-std::pair<bool, std::string> errorDiff(const fs::path& genFile, const fs::path& expFile) {
+Comparison compareOutput(std::string_view generated, std::string_view expected,
+                         const std::optional<std::string>& expErrorString,
+                         const Comparator& comparator) {
+
+  Comparison comparison = comparator.compare(generated, expected);
+  if (comparison.passed())
+    return comparison;
+
+  std::optional<std::string> genErrorString = getErrorString(generated);
+  if (genErrorString.has_value() && genErrorString == expErrorString)
+    comparison.match = OutputMatch::ErrorLine;
+  return comparison;
+}
 
-  auto genErrorString = getErrorString(genFile);
-  auto expErrorString = getErrorString(expFile);
+Comparison compareOutput(std::string_view generated, const ExpectedOutput& expected,
+                         const Comparator& comparator) {
+  return compareOutput(generated, expected.contents, expected.errorString, comparator);
+}
 
-  if ( genErrorString.has_value() && expErrorString.has_value()
-                                 && *genErrorString == *expErrorString ) {
-    return {false, ""};
+/**
+ * @brief Hash a file a chunk at a time, so an output of any size takes little
+ * memory. Returns false if the file can't be opened.
+ */
+bool hashFile(const fs::path& path, Sha256::Digest& digest, uint64_t& size) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file.is_open())
+    return false;
+
+  Sha256 hash;
+  std::vector<char> buffer(CHUNK_BYTES);
+  size = 0;
+  while (file) {
+    file.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    size_t read = static_cast<size_t>(file.gcount());
+    hash.add(std::string_view(buffer.data(), read));
+    size += read;
   }
-
-  std::string diffStr = ""; 
-  return std::make_pair(true, std::move(diffStr));
-} 
-
-} // end anonymous namespace
-
-namespace tester {
+  digest = hash.finish();
+  return true;
+}
 
 /**
  * @brief: Invoke the toolchain for the current test. Commands that exit with non-zero
@@ -190,66 +199,101 @@ namespace tester {
  * property. If "allowError" is true, then non-zero exits break the toolchain immediately and we check
  * the stderr of the command instead of stdout.
  */
-TestResult runTest(TestFile* test, const ToolChain& toolChain, const Config& cfg) {
+TestExecution executeTest(TestFile* test, const ToolChain& toolChain, const fs::path& scratchDir) {
+
+  // Judge the output as it is written if asked to, stopping the final step
+  // as soon as it is known to fail. Only exact matches can be judged a chunk
+  // at a time.
+  std::optional<StreamVerdict> verdict;
+  OutputWatcher watcher;
+  uint64_t written = 0;
+  if (toolChain.streamsVerdict() && test->getExpectedHash().has_value()) {
+    // A hashed output can only be judged by its length before it is complete.
+    uint64_t limit = test->getExpectedHash()->size;
+    watcher = [&written, limit](std::string_view chunk) {
+      written += chunk.size();
+      return written <= limit;
+    };
+  } else if (toolChain.streamsVerdict() && getComparator(test, toolChain).isExact()) {
+    verdict.emplace(test->getExpectedOutput());
+    watcher = [&verdict](std::string_view chunk) { return verdict->consume(chunk); };
+  }
 
-  const fs::path testPath = test->getTestPath();
-  const fs::path expOutPath = test->getOutPath();
-  const fs::path insPath = test->getInsPath(); 
-  fs::path genOutPath;
-  std::string genErrorString, expErrorString, diffString;
-  
-  // Track test results 
-  bool testDiff = false, testError = false;
-  std::pair<bool, std::string> testResult; 
-
-  ExecutionOutput eo;
+  TestExecution execution;
   try {
-    eo = toolChain.build(test);
+    execution.output = toolChain.build(test, watcher, scratchDir);
+    execution.streamedMatch =
+        verdict.has_value() && verdict->matched() && !execution.output.IsErrorTest();
+  } catch (const CommandException& ce) {
+    // toolchain throws errors only when allowError is false in the config
+    execution.failure = ce.what();
+    execution.timedOut = dynamic_cast<const TimeoutException*>(&ce) != nullptr;
+  }
+  return execution;
+}
 
-    // For error tests, we will use the stderr stream of the execution output.
-    if (eo.IsErrorTest()) {
-      genOutPath = eo.getErrorFile();
-    } else {
-      genOutPath = eo.getOutputFile();
-    }
+/**
+ * @brief Judge the output a test's toolchain left behind, writing whatever
+ * the verbosity asks for about it to `log`.
+ */
+TestResult judgeTest(TestFile* test, const ToolChain& toolChain, const TestExecution& execution,
+                     const Config& cfg, std::ostream& log) {
 
-    // Check if we were able to create the output file
-    std::ifstream file(genOutPath);
-    if (!file.is_open()) {
-      return TestResult(testPath, false, true, "Failed to create output file");
-    }
+  const fs::path testPath = test->getTestPath();
+  const fs::path expOutPath = test->getOutPath();
+  const ExecutionOutput& eo = execution.output;
+  int verbosity = cfg.getVerbosity();
 
-  } catch (const CommandException& ce) {
-    // toolchain throws errors only when allowError is false in the config
-    if (cfg.getVerbosity() > 0) {
-      std::cout << Colors::YELLOW << "    [ERROR] " << Colors::RESET << ce.what() << '\n';
+  if (execution.failure.has_value()) {
+    if (verbosity > 0) {
+      log << Colors::YELLOW << "    [ERROR] " << Colors::RESET << *execution.failure << '\n';
     }
     return TestResult(testPath, false, true, "");
   }
- 
-  // Make a precise diff and fallback to error diff if  the precise diff failed.
-  testResult = preciseDiff(genOutPath, expOutPath);
-  if (testResult.first) {
-    testResult = errorDiff(genOutPath, expOutPath);   
+
+  // A streamed exact match needs nothing more.
+  if (execution.streamedMatch) {
+    if (verbosity == 3)
+      formatFileDump(log, testPath, expOutPath, eo.getOutputFile());
+    return TestResult(testPath, true, false, "", {OutputMatch::Exact});
   }
 
-  // Unpack results
-  std::tie(testDiff, diffString) = testResult;
+  // For error tests, we will use the stderr stream of the execution output.
+  const fs::path genOutPath = eo.IsErrorTest() ? eo.getErrorFile() : eo.getOutputFile();
+
+  // Outputs known only by their digest are hashed as they are read.
+  if (test->getExpectedHash().has_value())
+    return judgeHashedTest(test, genOutPath, verbosity, log);
+
+  // Check if we were able to create the output file
+  std::ifstream file(genOutPath, std::ios::binary);
+  if (!file.is_open()) {
+    return TestResult(testPath, false, true, "Failed to create output file");
+  }
+  std::string genOutput(std::istreambuf_iterator<char>(file), {});
+
+  // The expected output is read once per test and shared by every run of it.
+  const ExpectedOutput& expected = test->getExpectedOutput();
+  Comparison comparison = compareOutput(genOutput, expected, getComparator(test, toolChain));
+  bool testDiff = !comparison.passed();
 
   // if there is a diff in the output, pick the defined way to display it based on config.
-  int verbosity = cfg.getVerbosity();
   if (verbosity == 3) {
     // highest level of verbosity results in printing the full output even for passing tests.
-    formatFileDump(testPath, expOutPath, genOutPath);
+    formatFileDump(log, testPath, expOutPath, genOutPath);
   } else if (verbosity == 2 && testDiff) {
     // level two dump the relevant files
-    formatFileDump(testPath, expOutPath, genOutPath);
+    formatFileDump(log, testPath, expOutPath, genOutPath);
   } else if (verbosity == 1 && testDiff) {
-    // level one simply print the diff string
-    std::cout << diffString << std::endl;
+    // level one simply print the diff, which is only worth making now
+    if (comparison.line != 0)
+      log << "First difference at line " << comparison.line << ", column " << comparison.column
+          << '\n';
+    log << renderDiff(expected.contents, expected.lines, genOutput, indexLines(genOutput))
+        << std::endl;
   }
-  
-  return TestResult(testPath, !testDiff, testError, "");
+
+  return TestResult(testPath, !testDiff, false, "", comparison);
 }
 
 } // End namespace tester
@@ -0,0 +1,155 @@
+#include "toolchain/Builtin.h"
+
+#include <stdexcept>
+
+namespace {
+
+const std::string PREFIX = "builtin:";
+
+// Parse a line count, with a leading '+' if allowed.
+size_t parseCount(const std::string& exe, std::string count, bool allowPlus, bool& plus) {
+  // Allow the "-n +6" spelling, where the space is part of the argument.
+  size_t start = count.find_first_not_of(' ');
+  count = start == std::string::npos ? "" : count.substr(start);
+
+  plus = allowPlus && !count.empty() && count[0] == '+';
+  if (plus)
+    count = count.substr(1);
+  if (count.empty() || count.find_first_not_of("0123456789") != std::string::npos)
+    throw std::runtime_error(exe + ": invalid line count '" + count + "'.");
+  return std::stoul(count);
+}
+
+// Split off every line including its newline, the last line may lack one.
+template <typename Fn>
+void forEachLine(std::string_view text, Fn fn) {
+  while (!text.empty()) {
+    size_t end = text.find('\n');
+    end = end == std::string_view::npos ? text.size() : end + 1;
+    fn(text.substr(0, end));
+    text.remove_prefix(end);
+  }
+}
+
+} // End anonymous namespace
+
+namespace tester {
+
+bool Builtin::isBuiltin(const std::string& exe) { return exe.rfind(PREFIX, 0) == 0; }
+
+Builtin::Builtin(const std::string& exe, const std::vector<std::string>& args) {
+  std::string name = exe.substr(PREFIX.size());
+  if (name == "head" || name == "tail") {
+    kind = name == "head" ? Kind::Head : Kind::Tail;
+    parseLineArgs(exe, args);
+  } else if (name == "strip-ansi") {
+    kind = Kind::StripAnsi;
+    if (args.size() > 1)
+      throw std::runtime_error(exe + " takes at most an input file.");
+    if (args.size() == 1)
+      inputArg = 0;
+  } else if (name == "regex-replace") {
+    kind = Kind::RegexReplace;
+    if (args.size() != 2 && args.size() != 3)
+      throw std::runtime_error(exe + " takes a pattern, a replacement and optionally an input "
+                               "file.");
+    try {
+      pattern = std::regex(args[0]);
+    } catch (const std::regex_error& e) {
+      throw std::runtime_error(exe + ": invalid pattern '" + args[0] + "': " + e.what());
+    }
+    replacement = args[1];
+    if (args.size() == 3)
+      inputArg = 2;
+  } else {
+    throw std::runtime_error("Unknown builtin: " + exe);
+  }
+}
+
+void Builtin::parseLineArgs(const std::string& exe, const std::vector<std::string>& args) {
+  bool allowPlus = kind == Kind::Tail;
+  for (size_t i = 0; i < args.size(); ++i) {
+    const std::string& arg = args[i];
+    if (arg == "-n") {
+      if (++i == args.size())
+        throw std::runtime_error(exe + ": -n needs a line count.");
+      lines = parseCount(exe, args[i], allowPlus, fromStart);
+    } else if (arg.rfind("-n", 0) == 0) {
+      lines = parseCount(exe, arg.substr(2), allowPlus, fromStart);
+    } else if (arg.size() > 1 && arg[0] == '-') {
+      throw std::runtime_error(exe + ": unsupported option '" + arg + "'.");
+    } else if (inputArg.has_value()) {
+      throw std::runtime_error(exe + " takes at most one input file.");
+    } else {
+      inputArg = i;
+    }
+  }
+}
+
+std::optional<size_t> Builtin::getLineLimit() const {
+  return kind == Kind::Head ? std::optional<size_t>(lines) : std::nullopt;
+}
+
+std::string Builtin::run(std::string_view input) const {
+  std::string output;
+  switch (kind) {
+  case Kind::Head:
+    forEachLine(input, [&, count = size_t(0)](std::string_view line) mutable {
+      if (count++ < lines)
+        output += line;
+    });
+    break;
+
+  case Kind::Tail:
+    if (fromStart) {
+      // Line numbers start at one, "+0" is the same as "+1".
+      forEachLine(input, [&, number = size_t(1)](std::string_view line) mutable {
+        if (number++ >= lines)
+          output += line;
+      });
+    } else {
+      // Walk back over the last `lines` line starts. A final newline ends the
+      // last line rather than starting an empty one.
+      size_t start = input.size();
+      size_t end = !input.empty() && input.back() == '\n' ? input.size() - 1 : input.size();
+      for (size_t found = 0; found < lines && start != 0; ++found) {
+        size_t newline = end == 0 ? std::string_view::npos : input.rfind('\n', end - 1);
+        start = newline == std::string_view::npos ? 0 : newline + 1;
+        end = newline == std::string_view::npos ? 0 : newline;
+      }
+      output = input.substr(start);
+    }
+    break;
+
+  case Kind::StripAnsi:
+    // Drop control sequences: ESC '[', parameter and intermediate bytes, then a final byte.
+    output.reserve(input.size());
+    for (size_t i = 0; i < input.size(); ++i) {
+      if (input[i] == '\x1b' && i + 1 < input.size() && input[i + 1] == '[') {
+        size_t j = i + 2;
+        while (j < input.size() && input[j] >= 0x20 && input[j] <= 0x3f)
+          ++j;
+        if (j < input.size() && input[j] >= 0x40 && input[j] <= 0x7e) {
+          i = j;
+          continue;
+        }
+      }
+      output += input[i];
+    }
+    break;
+
+  case Kind::RegexReplace:
+    // Lines are replaced on their own so ^ and $ anchor to lines.
+    forEachLine(input, [&](std::string_view line) {
+      bool newline = line.back() == '\n';
+      std::string text(line.substr(0, line.size() - newline));
+      output += std::regex_replace(text, pattern, replacement);
+      if (newline)
+        output += '\n';
+    });
+    break;
+  }
+  return output;
+}
+
+} // End namespace tester
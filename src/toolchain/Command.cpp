@@ -3,14 +3,26 @@
 #include "util.h"
 
 #include "toolchain/CommandException.h"
+#include "toolchain/Metrics.h"
+#include "toolchain/PersistentWorker.h"
+#include "toolchain/Pipes.h"
 
+#include <algorithm>
+#include <cerrno>
 #include <chrono>
+#include <csignal>
 #include <cstdlib>
 #include <fcntl.h>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <string_view>
+#include <sys/resource.h>
 #include <thread>
 #include <unistd.h>
 
 #if __linux__
+#include <sys/prctl.h>
 #include <wait.h>
 #elif __APPLE__
 #include <signal.h>
@@ -38,15 +50,30 @@ int redirectStdStream(const std::string& file_str, int flags, mode_t mode, int d
   return 0; 
 }
 
-void becomeCommand(const std::string& exe,
-                   const std::vector<std::string>& trueArgs,
-                   const std::string& input,
-                   const std::string& output,
-                   const std::string& error,
-                   const std::string& runtime
-  ) {
+// Everything the child needs to turn itself into the command.
+struct ChildSetup {
+  std::string exe;
+  std::vector<std::string> trueArgs;
+  std::string input, output, error, runtime;
+  tester::CpuList cpus;
+
+  // Pipe ends replacing the input and output files of a piped step, or -1.
+  int stdinPipe{-1}, stdoutPipe{-1};
+
+  // Bytes of address space the command may use, if limited.
+  std::optional<uint64_t> memoryLimit;
+
+  // Lead a process group of its own, killed as a whole.
+  bool ownProcessGroup{false};
+};
+
+void becomeCommand(const ChildSetup& child) {
+  const std::string& exe = child.exe;
+  const std::vector<std::string>& trueArgs = child.trueArgs;
+  const std::string& runtime = child.runtime;
+
   // Error and output files should never be empty.
-  assert(!error.empty() && !output.empty());
+  assert(!child.error.empty() && !child.output.empty());
 
   // Build a list of true arguments.
   const char* args[trueArgs.size() + 2];
@@ -76,10 +103,29 @@ void becomeCommand(const std::string& exe,
   env[2] = ld_library_path.c_str();
   env[3] = NULL;
 
+  // Keep to our lane of CPUs, a failure here only costs timing quality. This
+  // and the memory limit come before the redirections, so their errors go to
+  // the tester's stderr instead of the output a test compares.
+  if (!tester::pinToCpus(child.cpus))
+    perror("sched_setaffinity");
+
+  // Allocations past the test's memory limit fail in the command.
+  if (child.memoryLimit.has_value()) {
+    rlimit limit{static_cast<rlim_t>(*child.memoryLimit), static_cast<rlim_t>(*child.memoryLimit)};
+    if (setrlimit(RLIMIT_AS, &limit) == -1) {
+      perror("setrlimit");
+      exit(EXIT_FAILURE);
+    }
+  }
+
   // Open the supplied files and redirect FD of the current child process to them.
-  int outFileStatus = redirectStdStream(output.c_str(), O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR, STDOUT_FILENO);
-  int errorFileStatus = redirectStdStream(error.c_str(), O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR, STDERR_FILENO);
-  int inFileStatus = !input.empty() ? redirectStdStream(input.c_str(), O_RDONLY, 0, STDIN_FILENO) : 0;
+  // Pipes to neighbouring steps take the place of the files.
+  int outFileStatus = child.stdoutPipe != -1
+    ? dup2(child.stdoutPipe, STDOUT_FILENO)
+    : redirectStdStream(child.output, O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR, STDOUT_FILENO);
+  int errorFileStatus = redirectStdStream(child.error, O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR, STDERR_FILENO);
+  int inFileStatus = child.stdinPipe != -1 ? dup2(child.stdinPipe, STDIN_FILENO)
+    : !child.input.empty() ? redirectStdStream(child.input, O_RDONLY, 0, STDIN_FILENO) : 0;
 
   // If opening any of the supplied output, input, or error files failed, raise here.
   if (outFileStatus == -1 || errorFileStatus == -1 || inFileStatus == -1) {
@@ -95,38 +141,209 @@ void becomeCommand(const std::string& exe,
   exit(EXIT_FAILURE);
 }
 
+/// @brief Count the live processes in a process group. Zombies are not counted
+/// since they are already dead and only waiting to be reaped.
+unsigned int countProcessGroup(pid_t pgid) {
+#if __linux__
+  unsigned int count = 0;
+  std::error_code ec;
+  for (const auto& entry : fs::directory_iterator("/proc", ec)) {
+    const std::string pid = entry.path().filename().string();
+    if (pid.find_first_not_of("0123456789") != std::string::npos)
+      continue;
+
+    // The format is "pid (comm) state ppid pgrp ...", comm may contain spaces.
+    std::ifstream statFile(entry.path() / "stat");
+    std::string stat;
+    if (!std::getline(statFile, stat))
+      continue;
+    size_t commEnd = stat.rfind(')');
+    if (commEnd == std::string::npos)
+      continue;
+    std::istringstream fields(stat.substr(commEnd + 1));
+    char state;
+    pid_t ppid, pgrp;
+    if (fields >> state >> ppid >> pgrp && pgrp == pgid && state != 'Z')
+      ++count;
+  }
+  return count;
+#else
+  return kill(-pgid, 0) == 0 ? 1 : 0;
+#endif
+}
+
+/// @brief Kill everything left in a command's process group and reap what we
+/// can. Since the tester is a subreaper, orphaned descendants are handed to us
+/// as their parents die. Returns how many processes were still alive.
+unsigned int killProcessGroup(pid_t pgid) {
+  // Usually the group died with the command, skip the scan.
+  if (kill(-pgid, 0) == -1)
+    return 0;
+
+  unsigned int alive = countProcessGroup(pgid);
+  if (kill(-pgid, SIGKILL) == -1)
+    return alive;
+
+  // Give the kernel a moment to tear the group down, reaping as we go.
+  for (int tries = 0; tries < 100 && kill(-pgid, 0) == 0; ++tries) {
+    while (waitpid(-pgid, nullptr, WNOHANG) > 0)
+      ;
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return alive;
+}
+
+/// @brief Become the reaper of orphaned descendants so a command's children
+/// stay reachable after the command itself exits.
+void becomeSubreaper() {
+  static std::once_flag once;
+  std::call_once(once, []() {
+#if __linux__
+    if (prctl(PR_SET_CHILD_SUBREAPER, 1) == -1)
+      perror("prctl,PR_SET_CHILD_SUBREAPER");
+#endif
+  });
+}
+
+bool readFile(const fs::path& path, std::string& contents) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file)
+    return false;
+  std::ostringstream ss;
+  ss << file.rdbuf();
+  contents = ss.str();
+  return true;
+}
+
+// Start a persistent worker, talking to it over pipes on its stdin and stdout.
+// Returns nullptr if it couldn't be started.
+std::unique_ptr<tester::PersistentWorker> startWorker(ChildSetup child) {
+  int toWorker[2], fromWorker[2];
+  if (!tester::openPipe(toWorker))
+    return nullptr;
+  if (!tester::openPipe(fromWorker)) {
+    close(toWorker[0]);
+    close(toWorker[1]);
+    return nullptr;
+  }
+  child.output = child.error = "/dev/null";
+  child.stdinPipe = toWorker[0];
+  child.stdoutPipe = fromWorker[1];
+
+  pid_t childId = fork();
+  if (childId == 0) {
+    setpgid(0, 0);
+    becomeCommand(child);
+  }
+  if (childId != -1)
+    setpgid(childId, childId);
+  close(toWorker[0]);
+  close(fromWorker[1]);
+
+  if (childId == -1) {
+    perror("fork");
+    close(toWorker[1]);
+    close(fromWorker[0]);
+    return nullptr;
+  }
+  return std::make_unique<tester::PersistentWorker>(childId, toWorker[1], fromWorker[0]);
+}
+
+// Mention a time limit set for one run, since it isn't the usual --timeout.
+std::string describeLimit(const tester::ExecutionInput& ei) {
+  if (!ei.getTimeout().has_value())
+    return "";
+  std::ostringstream oss;
+  oss << " after its limit of " << *ei.getTimeout() << "s";
+  return oss.str();
+}
+
+// Counters being unavailable is a property of the machine, so only say it once.
+void warnCountersUnavailable(const std::string& reason) {
+  static std::once_flag warned;
+  std::call_once(warned, [&]() {
+    std::cerr << "Hardware performance counters unavailable: " << reason << '\n';
+  });
+}
+
 // This can get a bit complicated. We want easy command running which is
 // available in a cross platform manner via std::system but there's no way for
 // us to kill a long running subprocess (i.e. there's an infinite loop in a
 // test). This means we need to fall back on forking/execing, unfortunately.
 void runCommand(std::promise<unsigned int>& promise, std::atomic_bool& killVar,
-                const std::string& exe, const std::vector<std::string>& trueArgs,
-                const std::string& input,
-                const std::string& output,
-                const std::string& error,
-                const std::string& runtime) {
-
+                const std::atomic_bool* stopVar,
+                const ChildSetup& child,
+                bool measureCounters,
+                std::optional<tester::PerfCounters>& counters,
+                std::optional<double>& cpuTime,
+                unsigned int& leaked) {
+
+  // When counting, the child waits on this pipe until its counters are armed.
+  int gate[2] = {-1, -1};
+  if (measureCounters && pipe(gate) == -1)
+    perror("pipe");
+
+  auto forkStart = std::chrono::steady_clock::now();
   pid_t childId = fork();
 
   // We're the child process, we want to replace our process image with the
   // shell running the command. This function will never return if successful
   // and will throw a runtime_error if it is unsuccessful.
-  if (childId == 0)
-    becomeCommand(exe, trueArgs, input, output, error, runtime);
+  if (childId == 0) {
+    // Lead a new process group so the command and everything it spawns can
+    // be killed together.
+    if (child.ownProcessGroup)
+      setpgid(0, 0);
+
+    if (gate[0] != -1) {
+      close(gate[1]);
+      char go;
+      while (read(gate[0], &go, 1) == -1 && errno == EINTR)
+        ;
+      close(gate[0]);
+    }
+    becomeCommand(child);
+  }
+
+  // Also set the group from our side, we may otherwise try to kill the group
+  // before the child got to it. Fails harmlessly if the child already exec'd.
+  if (child.ownProcessGroup)
+    setpgid(childId, childId);
+  tester::Metrics::get().observeSpawn(
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - forkStart).count());
+
+  // The child holds its own copies of the pipe ends now. Ours have to go or
+  // the reader of the pipe would never see the end of its input.
+  tester::closePipe(child.stdinPipe);
+  tester::closePipe(child.stdoutPipe);
+
+  // Arm the counters, then release the child by closing our end of the gate.
+  tester::PerfCounterGroup perf;
+  bool counting = false;
+  if (gate[0] != -1) {
+    close(gate[0]);
+    counting = perf.attach(childId);
+    if (!counting)
+      warnCountersUnavailable(perf.getError());
+    close(gate[1]);
+  }
 
   // We're in the parent process. Set up variables for watching the child
-  // process.
+  // process. Reaping it with wait4 also tells us the CPU time it used.
   int status;
   pid_t closing;
+  rusage usage{};
 
   // Initial attempt to wait.
-  closing = waitpid(childId, &status, WNOHANG);
+  closing = wait4(childId, &status, WNOHANG, &usage);
 
-  // Our busy loop, continually asking about the status of the child.
-  while (closing == 0 && !killVar.load()) {
+  // Our busy loop, continually asking about the status of the child. Whoever
+  // watches the output may also stop it once it has seen enough.
+  auto stopping = [&]() { return killVar.load() || (stopVar && stopVar->load()); };
+  while (closing == 0 && !stopping()) {
     // Sleep for a bit then ask again.
     std::this_thread::sleep_for(std::chrono::milliseconds(10));
-    closing = waitpid(childId, &status, WNOHANG);
+    closing = wait4(childId, &status, WNOHANG, &usage);
   }
 
   // We had an error instead of actually exiting succesfully.
@@ -143,9 +360,10 @@ void runCommand(std::promise<unsigned int>& promise, std::atomic_bool& killVar,
   // remove, but we can handle it). This means that the child has already been
   // reaped so we should not kill and wait on it. We check for equality with
   // zero because < 0 is handled above and > 0 we have already killed.
-  if (killVar.load() && closing == 0) {
-    // Try to kill the sub process.
-    int killResult = kill(childId, SIGKILL);
+  if (stopping() && closing == 0) {
+    // Try to kill the sub process, and everything in its process group if it
+    // leads one.
+    int killResult = kill(child.ownProcessGroup ? -childId : childId, SIGKILL);
 
     // Somehow we weren't able to send a kill signal to our child process.
     if (killResult < 0) {
@@ -154,7 +372,7 @@ void runCommand(std::promise<unsigned int>& promise, std::atomic_bool& killVar,
     }
 
     // Try to wait on the killed subprocess to reap it.
-    closing = waitpid(childId, &status, 0);
+    closing = wait4(childId, &status, 0, &usage);
 
     // We had an error instead of killing successfully. Very weird
     // considering we send SIGKILL not SIGTERM.
@@ -164,6 +382,18 @@ void runCommand(std::promise<unsigned int>& promise, std::atomic_bool& killVar,
                                "Check for zombie processes.");
     }
   }
+
+  // The command is done, anything left in its group was leaked by it. Kill
+  // and reap those so they don't slowly starve the rest of the run.
+  if (child.ownProcessGroup)
+    leaked = killProcessGroup(childId);
+
+  // The child is reaped, so the counters hold its final totals.
+  if (counting)
+    counters = perf.read();
+  auto seconds = [](const timeval& time) { return time.tv_sec + time.tv_usec / 1e6; };
+  cpuTime = seconds(usage.ru_utime) + seconds(usage.ru_stime);
+
   // Set our return value and let the thread end.
   promise.set_value_at_thread_exit(static_cast<unsigned int>(status));
 }
@@ -173,7 +403,8 @@ void runCommand(std::promise<unsigned int>& promise, std::atomic_bool& killVar,
 namespace tester {
 
 Command::Command(const JSON& step, int64_t timeout)
-    : usesRuntime(false), usesInStr(false), timeout(timeout) {
+    : usesRuntime(false), usesInStr(false), allowError(false), pipeFromPrevious(false),
+      persistent(false), streamVerdict(false), timeout(timeout) {
   // Make sure the step has all of the values needed for construction.
   ensureContains(step, "stepName");
   ensureContains(step, "executablePath");
@@ -192,6 +423,8 @@ Command::Command(const JSON& step, int64_t timeout)
   // Set the executable path
   std::string path = step["executablePath"];
   exePath = fs::path(path);
+  if (Builtin::isBuiltin(path))
+    builtin.emplace(path, args);
 
   // Allow override of stdout path
   if (doesContain(step, "output"))
@@ -208,51 +441,195 @@ Command::Command(const JSON& step, int64_t timeout)
   // Do we allow errors?
   if (doesContain(step, "allowError"))
     allowError = step["allowError"];
+
+  // Do we read the previous step's stdout through a pipe? Then stdin is taken.
+  if (doesContain(step, "pipeFromPrevious"))
+    pipeFromPrevious = step["pipeFromPrevious"];
+  // Do we keep the executable running between tests?
+  if (doesContain(step, "persistent"))
+    persistent = step["persistent"];
+
+  // Do we compare the output while the command is still writing it?
+  if (doesContain(step, "streamVerdict"))
+    streamVerdict = step["streamVerdict"];
+
+  if (streamVerdict && (outputFile.has_value() || allowError))
+    throw std::runtime_error("Step '" + name + "' can only stream its verdict from stdout and "
+                             "without allowError.");
+
+  if (pipeFromPrevious && usesInStr)
+    throw std::runtime_error("Step '" + name + "' can't both pipe from the previous step and "
+                             "use the input stream.");
+
+  // Do we take many inputs per invocation? Only the per-input arguments may
+  // refer to an input or output, and each input needs its own output file.
+  if (doesContain(step, "batch")) {
+    batch = step["batch"];
+    if (doesContain(step, "batchArguments"))
+      for (std::string arg : step["batchArguments"])
+        batchArgs.push_back(arg);
+    else
+      batchArgs.push_back("$INPUT");
+
+    if (!outputFile.has_value() || usesInStr || pipeFromPrevious || builtin.has_value())
+      throw std::runtime_error("Batched step '" + name + "' needs an output file and can't use "
+                               "the input stream, pipes or builtins.");
+    for (const std::string& arg : args)
+      if (arg == "$INPUT" || arg == "$OUTPUT")
+        throw std::runtime_error("Batched step '" + name + "' can only use " + arg +
+                                 " in batchArguments.");
+  }
+}
+
+std::string Command::getSignature() const {
+  JSON signature = {{"exe", exePath.string()},
+                    {"args", args},
+                    {"output", outputFile.has_value() ? outputFile->string() : ""},
+                    {"usesRuntime", usesRuntime},
+                    {"usesInStr", usesInStr},
+                    {"allowError", allowError},
+                    {"pipeFromPrevious", pipeFromPrevious},
+                    {"batch", batch},
+                    {"batchArgs", batchArgs}};
+
+  // Without an output file $OUTPUT is named after the step, which the command sees.
+  if (!outputFile.has_value() && std::find(args.begin(), args.end(), "$OUTPUT") != args.end())
+    signature["name"] = name;
+  return signature.dump();
+}
+
+bool Command::isRelocatable() const {
+  if (!outputFile.has_value())
+    return true;
+  auto namesOutput = [](const std::vector<std::string>& list) {
+    return std::find(list.begin(), list.end(), "$OUTPUT") != list.end();
+  };
+  return namesOutput(args) || namesOutput(batchArgs);
+}
+
+fs::path Command::getBatchOutputFile(size_t index) const {
+  fs::path path = *outputFile;
+  return path.replace_filename(path.stem().string() + "." + std::to_string(index) +
+                               path.extension().string());
+}
+
+std::vector<ExecutionOutput> Command::executeBatch(const std::vector<ExecutionInput>& eis,
+                                                   size_t firstIndex) const {
+  // Run as a regular command whose arguments hold every input. It gets the
+  // timeout of all its inputs together.
+  Command batched(*this);
+  batched.batch = 0;
+  ExecutionInput batchEi = eis.front();
+  double limit = 0;
+  std::vector<ExecutionOutput> eos;
+  for (size_t i = 0; i < eis.size(); ++i) {
+    limit += eis[i].getTimeout().value_or(static_cast<double>(timeout));
+    eos.emplace_back(eis[i].placeOutput(getBatchOutputFile(firstIndex + i)),
+                     eis[i].placeOutput(errPath));
+    for (const std::string& arg : batchArgs)
+      batched.args.push_back(resolveArg(eis[i], eos.back(), arg).string());
+
+    // Old outputs would hide an input the invocation skipped.
+    std::error_code ec;
+    fs::remove(eos.back().getOutputFile(), ec);
+  }
+
+  // Results can't be told apart if the invocation failed, the caller runs
+  // each input on its own instead.
+  ExecutionOutput eo;
+  batchEi.setTimeout(limit);
+  try {
+    eo = batched.execute(batchEi);
+  } catch (const CommandException&) {
+    return {};
+  }
+  if (eo.getReturnValue() != 0)
+    return {};
+
+  for (ExecutionOutput& out : eos) {
+    out.setElapsedTime(eo.getElapsedTime().value_or(0) / eis.size());
+    out.setReturnValue(0);
+  }
+  return eos;
 }
 
 ExecutionOutput Command::execute(const ExecutionInput& ei) const {
   // Create our output context.
-  fs::path out = outputFile.has_value() ? *outputFile : outPath;
-  ExecutionOutput eo(out, errPath);
+  ExecutionOutput eo(getOutputPath(ei), ei.placeOutput(errPath));
+
+  // Builtins need no process at all.
+  if (builtin.has_value())
+    return executeBuiltin(ei, eo);
 
   // Always remove old output files so we know if a new one was created
   std::error_code ec;
 
   // Get the exe and its arguments, the things used in the actual execution of
-  // the command.
-  std::string exe = resolveExe(ei, eo, exePath).string();
-  std::vector<std::string> trueArgs;
-  for (const std::string& arg : args)
-    trueArgs.emplace_back(resolveArg(ei, eo, arg).string());
-
-  // Get the runtime path and standard out file, the things used in setting up
-  // the execution of the command.
-  std::string runtimeStr = usesRuntime ? ei.getTestedRuntime().string() : "";
-  std::string inPathStr = usesInStr ? ei.getInputStreamFile().string() : "";
-  std::string outPathStr = outPath.string();
-  std::string errPathStr = errPath.string();
+  // the command, along with the runtime path and standard streams, the things
+  // used in setting up the execution of the command. We own any pipe ends
+  // handed to us, so they are closed if the command can't even be set up.
+  ChildSetup child;
+  try {
+    child.exe = resolveExe(ei, eo, exePath).string();
+    for (const std::string& arg : args)
+      child.trueArgs.emplace_back(resolveArg(ei, eo, arg).string());
+
+    // On its own, a batched command runs a batch of one.
+    if (batch != 0)
+      for (const std::string& arg : batchArgs)
+        child.trueArgs.emplace_back(resolveArg(ei, eo, arg).string());
+  } catch (...) {
+    closePipe(ei.getStdinPipe());
+    closePipe(ei.getStdoutPipe());
+    throw;
+  }
+  child.runtime = usesRuntime ? ei.getTestedRuntime().string() : "";
+  child.input = usesInStr ? ei.getInputStreamFile().string() : "";
+  child.output = ei.placeOutput(outPath).string();
+  child.error = eo.getErrorFile().string();
+  child.cpus = ei.getCpuAffinity();
+  child.stdinPipe = ei.getStdinPipe();
+  child.stdoutPipe = ei.getStdoutPipe();
+  child.memoryLimit = ei.getMemoryLimit();
+  child.ownProcessGroup = killsProcessGroup;
+
+  // Persistent workers answer through our pipes and are processes we can't
+  // count or limit, so piped, counted or limited steps always get a process
+  // of their own.
+  if (persistent && child.stdinPipe == -1 && child.stdoutPipe == -1 && !ei.measuresCounters() &&
+      !ei.getMemoryLimit().has_value()) {
+    std::optional<ExecutionOutput> answered =
+        executePersistent(ei, eo, child.trueArgs, child.runtime);
+    if (answered.has_value())
+      return *answered;
+  }
 
   // Create the promise, which gives the future for the thread, and the kill
   // variable, the things used in the monitor thread.
   std::promise<unsigned int> promise;
   std::future<unsigned int> future = promise.get_future();
   std::atomic_bool kill(false);
+  std::optional<PerfCounters> counters;
+  std::optional<double> cpuTime;
+  unsigned int leaked = 0;
+  if (killsProcessGroup)
+    becomeSubreaper();
 
   // Run the command in another thread.
   auto start = std::chrono::high_resolution_clock::now(); // start recording timings
   std::thread thread =
       std::thread(runCommand, std::ref(promise), std::ref(kill), // Parent variables.
-                  std::ref(exe), std::ref(trueArgs),             // Child execution variables.
-                  std::ref(inPathStr),
-                  std::ref(outPathStr),
-                  std::ref(errPathStr), 
-                  std::ref(runtimeStr));
+                  ei.getStopFlag().get(),
+                  std::cref(child),                              // Child execution variables.
+                  ei.measuresCounters(), std::ref(counters), std::ref(cpuTime),
+                  std::ref(leaked));
 
   // Detach the thread to allow it to run in the background.
   thread.detach();
 
   // Wait to time out on the future. If we do, ask the thread to die.
-  if (future.wait_for(std::chrono::seconds(timeout)) == std::future_status::timeout) {
+  std::chrono::duration<double> limit(ei.getTimeout().value_or(timeout));
+  if (future.wait_for(limit) == std::future_status::timeout) {
     // Notify the thread we want it to die.
     kill.store(true);
 
@@ -264,16 +641,27 @@ ExecutionOutput Command::execute(const ExecutionInput& ei) const {
       throw std::runtime_error("Couldn't kill subprocess.");
 
     // We know we timed out, time to notify the higher-ups.
-    throw TimeoutException("Subcommand timed out:\n  " + buildCommand(ei, eo));
+    throw TimeoutException("Subcommand timed out" + describeLimit(ei) + ":\n  " +
+                           buildCommand(ei, eo));
   }
 
   // Finally get the result of the thread.
   int rv = future.get();
   auto end = std::chrono::high_resolution_clock::now();
 
+  // Report descendants the command left running, they have been killed.
+  if (leaked != 0)
+    std::cerr << Colors::YELLOW << "[LEAK] " << Colors::RESET << "Killed " << leaked
+              << " leftover descendant process(es) of:\n  " << buildCommand(ei, eo) << '\n';
+
+  // The output was already known to be wrong, so how the command ended
+  // doesn't matter. Its output so far is what gets compared.
+  if (ei.getStopFlag() && ei.getStopFlag()->load())
+    rv = 0;
+
   // If we exited "normally" we need to check the return code. If the return
   // code is 0, all is well.
-  if (WIFEXITED(rv)) {
+  else if (WIFEXITED(rv)) {
     // Get the exit status
     rv = WEXITSTATUS(rv);
 
@@ -286,6 +674,11 @@ ExecutionOutput Command::execute(const ExecutionInput& ei) const {
 
   // If we exited due to a signal we can dump the signal and throw an
   // exception.
+  // A step writing into a pipe is told to stop by SIGPIPE when the next step
+  // has read all it wants, like `head` does. That isn't a failure.
+  else if (WIFSIGNALED(rv) && WTERMSIG(rv) == SIGPIPE && ei.getStdoutPipe() != -1)
+    rv = 0;
+
   else if (WIFSIGNALED(rv)) {
     rv = WTERMSIG(rv);
     throw FailException("Subcommand terminated by signal " + std::to_string(rv) + ":\n  " +
@@ -300,9 +693,132 @@ ExecutionOutput Command::execute(const ExecutionInput& ei) const {
                              buildCommand(ei, eo));
 
   // Tell the toolchain about our output.
+  std::chrono::duration<double> elapsed = end - start;
+  eo.setElapsedTime(elapsed.count());
+  eo.setCpuTime(cpuTime);
+  eo.setReturnValue(rv);
+  eo.setPerfCounters(counters);
+  Metrics::get().observeStep(getName(), elapsed.count(), cpuTime);
+  return eo;
+}
+
+ExecutionOutput Command::executeBuiltin(const ExecutionInput& ei, ExecutionOutput eo) const {
+  auto start = std::chrono::high_resolution_clock::now();
+
+  // Read the input file argument, or stdin as a process would see it.
+  std::string input, error;
+  bool readInput = true;
+  try {
+    const std::optional<size_t>& inputArg = builtin->getInputArg();
+    if (inputArg.has_value()) {
+      fs::path inputPath = resolveArg(ei, eo, args[*inputArg]);
+      readInput = inputPath == "/dev/stdin" && ei.getStdinPipe() != -1
+        ? readAll(ei.getStdinPipe(), input, builtin->getLineLimit())
+        : readFile(inputPath, input);
+      if (!readInput)
+        error = getName() + ": can't read " + inputPath.string() + "\n";
+    } else if (ei.getStdinPipe() != -1) {
+      readInput = readAll(ei.getStdinPipe(), input, builtin->getLineLimit());
+    } else if (usesInStr) {
+      readInput = readFile(ei.getInputStreamFile(), input);
+    }
+  } catch (...) {
+    closePipe(ei.getStdinPipe());
+    closePipe(ei.getStdoutPipe());
+    throw;
+  }
+  closePipe(ei.getStdinPipe());
+  if (!readInput && error.empty())
+    error = getName() + ": can't read stdin\n";
+
+  // Produce the output just like a process would, into a file or a pipe.
+  std::string output = readInput ? builtin->run(input) : "";
+  bool wroteOutput = true;
+  if (ei.getStdoutPipe() != -1) {
+    writeAll(ei.getStdoutPipe(), output);
+    closePipe(ei.getStdoutPipe());
+  } else {
+    std::ofstream outFile(eo.getOutputFile(), std::ios::binary);
+    wroteOutput = static_cast<bool>(outFile << output);
+    if (!wroteOutput)
+      error += getName() + ": can't write " + eo.getOutputFile().string() + "\n";
+  }
+  std::ofstream(eo.getErrorFile(), std::ios::binary) << error;
+
+  int rv = readInput && wroteOutput ? 0 : 1;
+  if (rv != 0 && !allowError)
+    throw FailException("Builtin returned status code " + std::to_string(rv) + ":\n  " +
+                        buildCommand(ei, eo));
+
+  std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+  eo.setElapsedTime(elapsed.count());
+  eo.setReturnValue(rv);
+  Metrics::get().observeStep(getName(), elapsed.count(), std::nullopt);
+  return eo;
+}
+
+std::optional<ExecutionOutput> Command::executePersistent(const ExecutionInput& ei,
+                                                         ExecutionOutput eo,
+                                                         const std::vector<std::string>& trueArgs,
+                                                         const std::string& runtime) const {
+  // Workers are only shared when started the same way.
+  std::string exe = resolveExe(ei, eo, exePath).string();
+  std::string key = exe + '\n' + runtime;
+  for (int cpu : ei.getCpuAffinity())
+    key += ' ' + std::to_string(cpu);
+
+  WorkerPool& pool = WorkerPool::get();
+  if (pool.isDisabled(key))
+    return std::nullopt;
+  std::unique_ptr<PersistentWorker> worker = pool.take(key);
+  if (!worker) {
+    ChildSetup child;
+    child.exe = exe;
+    child.trueArgs = {"--persistent_worker"};
+    child.runtime = runtime;
+    child.cpus = ei.getCpuAffinity();
+    worker = startWorker(child);
+    if (!worker)
+      return std::nullopt;
+  }
+
+  JSON request = {{"arguments", trueArgs},
+                  {"inputStream", usesInStr ? ei.getInputStreamFile().string() : ""}};
+  WorkerResponse response;
+  auto start = std::chrono::high_resolution_clock::now();
+  PersistentWorker::Status status =
+      worker->request(request, ei.getTimeout().value_or(timeout), response);
+  auto end = std::chrono::high_resolution_clock::now();
+
+  if (status == PersistentWorker::Status::TimedOut && worker->hasAnswered())
+    throw TimeoutException("Persistent worker timed out" + describeLimit(ei) + ":\n  " +
+                           buildCommand(ei, eo));
+
+  // A worker that dies mid-request is replaced on the next one, this request
+  // runs as a process of its own. One that never answered doesn't know the
+  // protocol, whether it exited or ignored the request, so stop trying. It is
+  // killed on the way out.
+  if (status != PersistentWorker::Status::Answered) {
+    if (!worker->hasAnswered() && pool.disable(key))
+      std::cerr << Colors::YELLOW << "[WORKER] " << Colors::RESET << exe
+                << " does not answer as a persistent worker, running a process per test.\n";
+    return std::nullopt;
+  }
+  pool.giveBack(key, std::move(worker));
+
+  // Leave the same files behind a process would.
+  std::ofstream(ei.placeOutput(outPath), std::ios::binary) << response.out;
+  std::ofstream(eo.getErrorFile(), std::ios::binary) << response.err;
+
+  int rv = response.exitCode;
+  if (rv != 0 && !allowError)
+    throw FailException("Persistent worker returned status code " + std::to_string(rv) +
+                        ":\n  " + buildCommand(ei, eo));
+
   std::chrono::duration<double> elapsed = end - start;
   eo.setElapsedTime(elapsed.count());
   eo.setReturnValue(rv);
+  Metrics::get().observeStep(getName(), elapsed.count(), std::nullopt);
   return eo;
 }
 
@@ -316,6 +832,12 @@ std::string Command::buildCommand(const ExecutionInput& ei, const ExecutionOutpu
     command += ' ';
     command += resolveArg(ei, eo, arg).string();
   }
+  if (batch != 0) {
+    for (const std::string& arg : batchArgs) {
+      command += ' ';
+      command += resolveArg(ei, eo, arg).string();
+    }
+  }
 
   return command;
 }
@@ -0,0 +1,264 @@
+#include "toolchain/Comparator.h"
+
+#include "Hash.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+using tester::Comparison;
+using tester::OutputMatch;
+
+constexpr std::string_view WHITESPACE = " \t\r";
+constexpr double DEFAULT_TOLERANCE = 1e-6;
+
+// Walks a text line by line. A final newline ends the last line rather than
+// starting an empty one.
+class LineCursor {
+public:
+  explicit LineCursor(std::string_view text) : rest(text) {}
+
+  bool next(std::string_view& line) {
+    if (rest.empty())
+      return false;
+    size_t end = rest.find('\n');
+    line = rest.substr(0, end);
+    rest.remove_prefix(end == std::string_view::npos ? rest.size() : end + 1);
+    return true;
+  }
+
+private:
+  std::string_view rest;
+};
+
+std::string_view stripTrailing(std::string_view line) {
+  size_t end = line.find_last_not_of(WHITESPACE);
+  return line.substr(0, end == std::string_view::npos ? 0 : end + 1);
+}
+
+// Compare two texts line by line with `sameLine`, which sets the column of a
+// mismatch. Lines one text has beyond the other only match if `blankTail`
+// allows it.
+template <typename SameLine, typename BlankTail>
+Comparison compareLines(std::string_view generated, std::string_view expected,
+                        SameLine sameLine, BlankTail blankTail) {
+  if (generated == expected)
+    return {OutputMatch::Exact};
+
+  LineCursor gen(generated), exp(expected);
+  std::string_view genLine, expLine;
+  for (size_t line = 1;; ++line) {
+    bool hasGen = gen.next(genLine), hasExp = exp.next(expLine);
+    if (!hasGen && !hasExp)
+      return {OutputMatch::Equivalent};
+
+    size_t column = 1;
+    if (hasGen && hasExp && sameLine(genLine, expLine, column))
+      continue;
+    if (hasGen != hasExp && blankTail(hasGen ? genLine : expLine))
+      continue;
+    return {OutputMatch::Mismatch, line, column};
+  }
+}
+
+class ExactComparator : public tester::Comparator {
+public:
+  bool isExact() const override { return true; }
+
+  Comparison compare(std::string_view generated, std::string_view expected) const override {
+    if (generated == expected)
+      return {OutputMatch::Exact};
+
+    Comparison comparison{OutputMatch::Mismatch, 1, 1};
+    size_t length = std::min(generated.size(), expected.size());
+    for (size_t i = 0; i < length && generated[i] == expected[i]; ++i) {
+      if (generated[i] == '\n') {
+        ++comparison.line;
+        comparison.column = 1;
+      } else {
+        ++comparison.column;
+      }
+    }
+    return comparison;
+  }
+};
+
+// Ignores whitespace at the end of lines and blank lines at the end.
+class TrailingWhitespaceComparator : public tester::Comparator {
+public:
+  Comparison compare(std::string_view generated, std::string_view expected) const override {
+    auto sameLine = [](std::string_view gen, std::string_view exp, size_t& column) {
+      gen = stripTrailing(gen);
+      exp = stripTrailing(exp);
+      size_t length = std::min(gen.size(), exp.size());
+      while (column <= length && gen[column - 1] == exp[column - 1])
+        ++column;
+      return gen == exp;
+    };
+    auto blankTail = [](std::string_view line) { return stripTrailing(line).empty(); };
+    return compareLines(generated, expected, sameLine, blankTail);
+  }
+};
+
+// Compares lines token by token. Tokens that are both numbers match within a
+// tolerance, absolute for small numbers and relative for large ones. Other
+// tokens must be the same. Spacing between tokens doesn't matter.
+class NumericComparator : public tester::Comparator {
+public:
+  explicit NumericComparator(double tolerance) : tolerance(tolerance) {}
+
+  Comparison compare(std::string_view generated, std::string_view expected) const override {
+    auto sameLine = [this](std::string_view gen, std::string_view exp, size_t& column) {
+      size_t genPos = 0, expPos = 0;
+      for (;;) {
+        genPos = skipSpace(gen, genPos);
+        expPos = skipSpace(exp, expPos);
+        column = genPos + 1;
+        if (genPos == gen.size() || expPos == exp.size())
+          return genPos == gen.size() && expPos == exp.size();
+
+        std::string_view genToken = token(gen, genPos), expToken = token(exp, expPos);
+        if (!sameToken(genToken, expToken))
+          return false;
+        genPos += genToken.size();
+        expPos += expToken.size();
+      }
+    };
+    auto blankTail = [](std::string_view line) { return skipSpace(line, 0) == line.size(); };
+    return compareLines(generated, expected, sameLine, blankTail);
+  }
+
+private:
+  static size_t skipSpace(std::string_view line, size_t pos) {
+    pos = line.find_first_not_of(WHITESPACE, pos);
+    return pos == std::string_view::npos ? line.size() : pos;
+  }
+
+  static std::string_view token(std::string_view line, size_t pos) {
+    size_t end = line.find_first_of(WHITESPACE, pos);
+    return line.substr(pos, end == std::string_view::npos ? std::string_view::npos : end - pos);
+  }
+
+  // Parse a whole token as a number. strtod needs a terminated string, so the
+  // token is copied to the stack; longer tokens aren't numbers we compare.
+  static bool parseNumber(std::string_view token, double& value) {
+    char buffer[64];
+    if (token.empty() || token.size() >= sizeof(buffer))
+      return false;
+    std::memcpy(buffer, token.data(), token.size());
+    buffer[token.size()] = '\0';
+    char* end;
+    errno = 0;
+    value = std::strtod(buffer, &end);
+    return end == buffer + token.size() && errno != ERANGE;
+  }
+
+  bool sameToken(std::string_view gen, std::string_view exp) const {
+    if (gen == exp)
+      return true;
+    double genValue, expValue;
+    if (!parseNumber(gen, genValue) || !parseNumber(exp, expValue))
+      return false;
+    if (std::isnan(genValue) || std::isnan(expValue))
+      return std::isnan(genValue) && std::isnan(expValue);
+    if (std::isinf(genValue) || std::isinf(expValue))
+      return genValue == expValue;
+    double scale = std::max({1.0, std::fabs(genValue), std::fabs(expValue)});
+    return std::fabs(genValue - expValue) <= tolerance * scale;
+  }
+
+private:
+  double tolerance;
+};
+
+// Matches outputs holding the same lines in any order. The lines are first
+// summed up as a count and two order independent sums of their hashes, which
+// rejects most mismatches without storing anything. Sums can collide, so
+// outputs that agree on them are confirmed by sorting and comparing their
+// lines. There is no first difference to report.
+class UnorderedLinesComparator : public tester::Comparator {
+public:
+  Comparison compare(std::string_view generated, std::string_view expected) const override {
+    if (generated == expected)
+      return {OutputMatch::Exact};
+    if (summarise(generated) == summarise(expected) &&
+        sortedLines(generated) == sortedLines(expected))
+      return {OutputMatch::Equivalent};
+    return {OutputMatch::Mismatch};
+  }
+
+private:
+  struct Summary {
+    uint64_t count{0}, sum{0}, squares{0};
+    bool operator==(const Summary& other) const {
+      return count == other.count && sum == other.sum && squares == other.squares;
+    }
+  };
+
+  static Summary summarise(std::string_view text) {
+    Summary summary;
+    LineCursor cursor(text);
+    std::string_view line;
+    while (cursor.next(line)) {
+      tester::Fnv1a hash;
+      hash.add(line);
+      ++summary.count;
+      summary.sum += hash.get();
+      summary.squares += hash.get() * hash.get();
+    }
+    return summary;
+  }
+
+  static std::vector<std::string_view> sortedLines(std::string_view text) {
+    std::vector<std::string_view> lines;
+    LineCursor cursor(text);
+    std::string_view line;
+    while (cursor.next(line))
+      lines.push_back(line);
+    std::sort(lines.begin(), lines.end());
+    return lines;
+  }
+};
+
+} // End anonymous namespace
+
+namespace tester {
+
+const Comparator& Comparator::getExact() {
+  static const ExactComparator exact;
+  return exact;
+}
+
+std::shared_ptr<const Comparator> Comparator::create(const std::string& spec) {
+  size_t colon = spec.find(':');
+  std::string name = spec.substr(0, colon);
+  std::string argument = colon == std::string::npos ? "" : spec.substr(colon + 1);
+  if (colon != std::string::npos && name != "numeric")
+    throw std::runtime_error("Comparator '" + name + "' takes no argument.");
+
+  if (name == "exact")
+    return std::make_shared<ExactComparator>();
+  if (name == "ignore-trailing-whitespace")
+    return std::make_shared<TrailingWhitespaceComparator>();
+  if (name == "unordered-lines")
+    return std::make_shared<UnorderedLinesComparator>();
+  if (name == "numeric") {
+    double tolerance = DEFAULT_TOLERANCE;
+    if (colon != std::string::npos) {
+      char* end;
+      tolerance = std::strtod(argument.c_str(), &end);
+      if (argument.empty() || *end != '\0' || !(tolerance >= 0))
+        throw std::runtime_error("Invalid numeric comparator tolerance '" + argument + "'.");
+    }
+    return std::make_shared<NumericComparator>(tolerance);
+  }
+  throw std::runtime_error("Unknown comparator: " + spec);
+}
+
+} // End namespace tester
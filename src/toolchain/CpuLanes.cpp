@@ -0,0 +1,158 @@
+#include "toolchain/CpuLanes.h"
+
+#include <algorithm>
+#include <fstream>
+#include <set>
+#include <stdexcept>
+
+#if __linux__
+#include <sched.h>
+#endif
+
+namespace {
+
+/// @brief Parse a kernel CPU list such as "0-3,8,10-11".
+tester::CpuList parseCpuList(const std::string& list) {
+  tester::CpuList cpus;
+  size_t pos = 0;
+  while (pos < list.size()) {
+    size_t comma = list.find(',', pos);
+    std::string range = list.substr(pos, comma == std::string::npos ? std::string::npos
+                                                                     : comma - pos);
+    size_t dash = range.find('-');
+    try {
+      int first = std::stoi(range.substr(0, dash));
+      int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+      for (int cpu = first; cpu <= last; ++cpu)
+        cpus.push_back(cpu);
+    } catch (const std::exception&) {
+      // Trailing newline or otherwise empty entry.
+    }
+    if (comma == std::string::npos)
+      break;
+    pos = comma + 1;
+  }
+  return cpus;
+}
+
+/// @brief The CPUs the tester is currently allowed to run on.
+tester::CpuList getAllowedCpus() {
+  tester::CpuList cpus;
+#if __linux__
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+      if (CPU_ISSET(cpu, &set))
+        cpus.push_back(cpu);
+    }
+  }
+#endif
+  return cpus;
+}
+
+/// @brief The hardware threads sharing a physical core with `cpu`, including
+/// itself. Without topology information every CPU is its own core.
+tester::CpuList getSiblings(int cpu) {
+  std::ifstream siblings("/sys/devices/system/cpu/cpu" + std::to_string(cpu) +
+                         "/topology/thread_siblings_list");
+  std::string list;
+  if (!siblings.is_open() || !std::getline(siblings, list))
+    return {cpu};
+  tester::CpuList cpus = parseCpuList(list);
+  return cpus.empty() ? tester::CpuList{cpu} : cpus;
+}
+
+std::string formatCpuList(const tester::CpuList& cpus) {
+  std::string result;
+  for (size_t i = 0; i < cpus.size(); ++i) {
+    size_t j = i;
+    while (j + 1 < cpus.size() && cpus[j + 1] == cpus[j] + 1)
+      ++j;
+    if (!result.empty())
+      result += ',';
+    result += std::to_string(cpus[i]);
+    if (j != i)
+      result += '-' + std::to_string(cpus[j]);
+    i = j;
+  }
+  return "[" + result + "]";
+}
+
+} // end anonymous namespace
+
+namespace tester {
+
+CpuLanes CpuLanes::reserveCores(unsigned int count) {
+  CpuList allowed = getAllowedCpus();
+
+  // Group the allowed CPUs by physical core, each core is represented by its
+  // sorted sibling list.
+  std::set<CpuList> cores;
+  for (int cpu : allowed) {
+    CpuList siblings = getSiblings(cpu);
+    std::sort(siblings.begin(), siblings.end());
+    cores.insert(siblings);
+  }
+  if (count >= cores.size())
+    throw std::runtime_error("Cannot reserve " + std::to_string(count) +
+                             " cores for timed tests, only " + std::to_string(cores.size()) +
+                             " physical cores are available.");
+
+  // Reserve the last cores, using the lowest hardware thread of each.
+  CpuList reserved;
+  auto core = cores.rbegin();
+  for (unsigned int i = 0; i < count; ++i, ++core)
+    reserved.push_back(core->front());
+  return reserveCpus(reserved);
+}
+
+CpuLanes CpuLanes::reserveCpus(const CpuList& cpus) {
+  // Pinning to a CPU the tester may not use fails in every command.
+  CpuList allowed = getAllowedCpus();
+  for (int cpu : cpus) {
+    if (std::find(allowed.begin(), allowed.end(), cpu) == allowed.end())
+      throw std::runtime_error("Cannot reserve CPU " + std::to_string(cpu) +
+                               " for timed tests, the tester may only run on " +
+                               formatCpuList(allowed) + ".");
+  }
+
+  CpuLanes lanes;
+  lanes.timedCpus = cpus;
+  std::sort(lanes.timedCpus.begin(), lanes.timedCpus.end());
+
+  // Everything outside the reserved cores, including their siblings, is shared.
+  std::set<int> idle;
+  for (int cpu : cpus) {
+    for (int sibling : getSiblings(cpu))
+      idle.insert(sibling);
+  }
+  for (int cpu : getAllowedCpus()) {
+    if (idle.count(cpu) == 0)
+      lanes.sharedCpus.push_back(cpu);
+  }
+  if (lanes.sharedCpus.empty())
+    throw std::runtime_error("Reserving " + formatCpuList(lanes.timedCpus) +
+                             " for timed tests leaves no cores for the other tests.");
+  return lanes;
+}
+
+std::string CpuLanes::getDescription() const {
+  return "timed " + formatCpuList(timedCpus) + ", shared " + formatCpuList(sharedCpus);
+}
+
+bool pinToCpus(const CpuList& cpus) {
+  if (cpus.empty())
+    return true;
+#if __linux__
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (int cpu : cpus)
+    CPU_SET(cpu, &set);
+  return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+  return false;
+#endif
+}
+
+} // End namespace tester
@@ -0,0 +1,148 @@
+#include "toolchain/Metrics.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+namespace {
+
+// Bytes of memory the tester has resident now, or 0 if it can't tell.
+uint64_t getResidentBytes() {
+  std::ifstream statm("/proc/self/statm");
+  uint64_t size = 0, resident = 0;
+  if (!(statm >> size >> resident))
+    return 0;
+  return resident * static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+}
+
+// Escape a label value as the text format wants.
+std::string escapeLabel(const std::string& value) {
+  std::string escaped;
+  for (char c : value) {
+    if (c == '\\' || c == '"')
+      escaped += '\\';
+    if (c == '\n')
+      escaped += "\\n";
+    else
+      escaped += c;
+  }
+  return escaped;
+}
+
+} // End anonymous namespace
+
+namespace tester {
+
+// From a tenth of a millisecond, for spawns and quick steps, to a few
+// minutes, for statistically timed ones.
+const std::vector<double> Histogram::bounds = {0.0001, 0.0005, 0.001, 0.0025, 0.005, 0.01,
+                                               0.025,  0.05,   0.1,   0.25,   0.5,   1,
+                                               2.5,    5,      10,    30,     60,    300};
+
+Histogram::Histogram() : counts(new std::atomic<uint64_t>[bounds.size() + 1]) {
+  for (size_t i = 0; i <= bounds.size(); ++i)
+    counts[i] = 0;
+}
+
+void Histogram::observe(double seconds) {
+  size_t bucket = 0;
+  while (bucket < bounds.size() && seconds > bounds[bucket])
+    ++bucket;
+  ++counts[bucket];
+  ++count;
+  sumNanos += static_cast<uint64_t>(std::max(seconds, 0.0) * 1e9);
+}
+
+void Histogram::render(std::ostream& os, const std::string& name,
+                       const std::string& labels) const {
+  std::string prefix = labels.empty() ? "" : labels + ",";
+  uint64_t cumulative = 0;
+  for (size_t i = 0; i < bounds.size(); ++i) {
+    cumulative += counts[i];
+    os << name << "_bucket{" << prefix << "le=\"" << bounds[i] << "\"} " << cumulative << '\n';
+  }
+  cumulative += counts[bounds.size()];
+  os << name << "_bucket{" << prefix << "le=\"+Inf\"} " << cumulative << '\n';
+
+  std::string braces = labels.empty() ? "" : "{" + labels + "}";
+  os << name << "_sum" << braces << ' ' << sumNanos / 1e9 << '\n';
+  os << name << "_count" << braces << ' ' << count << '\n';
+}
+
+Metrics& Metrics::get() {
+  static Metrics metrics;
+  return metrics;
+}
+
+void Metrics::countTestJudged(bool pass, bool timedOut) {
+  ++(pass ? testsPassed : testsFailed);
+  if (timedOut)
+    ++testsTimedOut;
+}
+
+void Metrics::observeStep(const std::string& step, double wallSeconds,
+                          std::optional<double> cpuSeconds) {
+  std::pair<Histogram, Histogram>* histograms;
+  {
+    std::lock_guard<std::mutex> lock(stepMutex);
+    histograms = &steps[step];
+  }
+  histograms->first.observe(wallSeconds);
+  if (cpuSeconds.has_value())
+    histograms->second.observe(*cpuSeconds);
+}
+
+void Metrics::setQueueDepths(size_t run, size_t compare) {
+  runQueueDepth = run;
+  compareQueueDepth = compare;
+}
+
+std::string Metrics::render() const {
+  std::ostringstream os;
+  auto header = [&](const char* name, const char* type, const char* help) {
+    os << "# HELP " << name << ' ' << help << '\n' << "# TYPE " << name << ' ' << type << '\n';
+  };
+
+  header("tester_tests_started_total", "counter", "Tests whose toolchain started running.");
+  os << "tester_tests_started_total " << testsStarted << '\n';
+  header("tester_tests_passed_total", "counter", "Tests judged to pass.");
+  os << "tester_tests_passed_total " << testsPassed << '\n';
+  header("tester_tests_failed_total", "counter", "Tests judged to fail.");
+  os << "tester_tests_failed_total " << testsFailed << '\n';
+  header("tester_tests_timed_out_total", "counter", "Tests with a step that timed out.");
+  os << "tester_tests_timed_out_total " << testsTimedOut << '\n';
+
+  header("tester_spawn_seconds", "histogram", "Time to fork a step's process.");
+  spawn.render(os, "tester_spawn_seconds", "");
+  {
+    std::lock_guard<std::mutex> lock(stepMutex);
+    header("tester_step_wall_seconds", "histogram", "Wall time of a toolchain step.");
+    for (const auto& [step, histograms] : steps)
+      histograms.first.render(os, "tester_step_wall_seconds", "step=\"" + escapeLabel(step) + "\"");
+    header("tester_step_cpu_seconds", "histogram",
+           "User and system CPU time of a toolchain step's process.");
+    for (const auto& [step, histograms] : steps)
+      histograms.second.render(os, "tester_step_cpu_seconds", "step=\"" + escapeLabel(step) + "\"");
+  }
+  header("tester_compare_seconds", "histogram", "Time to judge a test's output.");
+  compare.render(os, "tester_compare_seconds", "");
+
+  header("tester_queue_depth", "gauge", "Tests waiting in a queue of the test pipeline.");
+  os << "tester_queue_depth{queue=\"run\"} " << runQueueDepth << '\n';
+  os << "tester_queue_depth{queue=\"compare\"} " << compareQueueDepth << '\n';
+
+  header("tester_resident_memory_bytes", "gauge", "Resident memory of the tester.");
+  os << "tester_resident_memory_bytes " << getResidentBytes() << '\n';
+  rusage usage{};
+  if (getrusage(RUSAGE_SELF, &usage) == 0) {
+    header("tester_peak_resident_memory_bytes", "gauge", "Peak resident memory of the tester.");
+    os << "tester_peak_resident_memory_bytes " << static_cast<uint64_t>(usage.ru_maxrss) * 1024
+       << '\n';
+  }
+  return os.str();
+}
+
+} // End namespace tester
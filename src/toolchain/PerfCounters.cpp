@@ -0,0 +1,99 @@
+#include "toolchain/PerfCounters.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <unistd.h>
+
+#if __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#endif
+
+namespace {
+
+#if __linux__
+// The events we count, in the same order as the fields of PerfCounters.
+const uint64_t EVENTS[] = {PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CPU_CYCLES,
+                           PERF_COUNT_HW_BRANCH_MISSES, PERF_COUNT_HW_CACHE_MISSES};
+
+int openCounter(uint64_t event, pid_t pid) {
+  perf_event_attr attr;
+  std::memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.config = event;
+
+  // Start counting when the child execs and include anything it spawns. Only
+  // user space is counted, which is all perf_event_paranoid=2 allows anyway.
+  attr.disabled = 1;
+  attr.enable_on_exec = 1;
+  attr.inherit = 1;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+
+  return static_cast<int>(syscall(SYS_perf_event_open, &attr, pid, -1, -1, PERF_FLAG_FD_CLOEXEC));
+}
+#endif
+
+std::string readParanoidLevel() {
+  std::ifstream paranoid("/proc/sys/kernel/perf_event_paranoid");
+  std::string level;
+  if (!paranoid.is_open() || !std::getline(paranoid, level))
+    return "unknown";
+  return level;
+}
+
+} // end anonymous namespace
+
+namespace tester {
+
+PerfCounterGroup::~PerfCounterGroup() { close(); }
+
+void PerfCounterGroup::close() {
+  for (int fd : fds) {
+    if (fd != -1)
+      ::close(fd);
+  }
+  fds.clear();
+}
+
+bool PerfCounterGroup::attach(pid_t pid) {
+  close();
+#if __linux__
+  bool any = false;
+  int lastErrno = 0;
+  for (uint64_t event : EVENTS) {
+    int fd = openCounter(event, pid);
+    if (fd == -1)
+      lastErrno = errno;
+    any |= fd != -1;
+    fds.push_back(fd);
+  }
+  if (any)
+    return true;
+
+  error = std::string(std::strerror(lastErrno)) +
+          " (perf_event_paranoid=" + readParanoidLevel() + ")";
+  close();
+  return false;
+#else
+  (void)pid;
+  error = "hardware counters are only supported on Linux";
+  return false;
+#endif
+}
+
+PerfCounters PerfCounterGroup::read() const {
+  PerfCounters counters;
+  std::optional<uint64_t>* fields[] = {&counters.instructions, &counters.cycles,
+                                       &counters.branchMisses, &counters.cacheMisses};
+  for (size_t i = 0; i < fds.size(); ++i) {
+    uint64_t value;
+    if (fds[i] != -1 && ::read(fds[i], &value, sizeof(value)) == sizeof(value))
+      *fields[i] = value;
+  }
+  return counters;
+}
+
+} // End namespace tester
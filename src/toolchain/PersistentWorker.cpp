@@ -0,0 +1,102 @@
+#include "toolchain/PersistentWorker.h"
+
+#include "toolchain/Pipes.h"
+
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <poll.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace tester {
+
+PersistentWorker::~PersistentWorker() {
+  closePipe(toWorker);
+  closePipe(fromWorker);
+  kill(-pid, SIGKILL);
+  waitpid(pid, nullptr, 0);
+}
+
+PersistentWorker::Status PersistentWorker::request(const JSON& request, double timeout,
+                                                   WorkerResponse& response) {
+  if (!writeAll(toWorker, request.dump() + '\n'))
+    return Status::Died;
+
+  // Read until a whole line arrived or we run out of time.
+  auto deadline = std::chrono::steady_clock::now() +
+                  std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                      std::chrono::duration<double>(timeout));
+  size_t newline;
+  while ((newline = buffered.find('\n')) == std::string::npos) {
+    auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+        deadline - std::chrono::steady_clock::now());
+    if (left.count() <= 0)
+      return Status::TimedOut;
+
+    pollfd readable{fromWorker, POLLIN, 0};
+    int ready = poll(&readable, 1, static_cast<int>(left.count()));
+    if (ready == -1 && errno == EINTR)
+      continue;
+    if (ready == 0)
+      return Status::TimedOut;
+
+    char chunk[65536];
+    ssize_t got = ready == -1 ? -1 : read(fromWorker, chunk, sizeof(chunk));
+    if (got == -1 && errno == EINTR)
+      continue;
+    if (got <= 0)
+      return Status::Died;
+    buffered.append(chunk, got);
+  }
+
+  // Anything but a well formed response is as good as a crash.
+  std::string line = buffered.substr(0, newline);
+  buffered.erase(0, newline + 1);
+  JSON json = JSON::parse(line, nullptr, false);
+  if (json.is_discarded() || !json.is_object() || !json.contains("exitCode") ||
+      !json["exitCode"].is_number_integer())
+    return Status::Died;
+
+  try {
+    response.exitCode = json["exitCode"];
+    response.out = json.value("stdout", "");
+    response.err = json.value("stderr", "");
+  } catch (const JSON::type_error&) {
+    return Status::Died;
+  }
+  answered = true;
+  return Status::Answered;
+}
+
+WorkerPool& WorkerPool::get() {
+  static WorkerPool pool;
+  return pool;
+}
+
+std::unique_ptr<PersistentWorker> WorkerPool::take(const std::string& key) {
+  std::lock_guard<std::mutex> lock(mutex);
+  auto workers = idle.find(key);
+  if (workers == idle.end() || workers->second.empty())
+    return nullptr;
+  std::unique_ptr<PersistentWorker> worker = std::move(workers->second.back());
+  workers->second.pop_back();
+  return worker;
+}
+
+void WorkerPool::giveBack(const std::string& key, std::unique_ptr<PersistentWorker> worker) {
+  std::lock_guard<std::mutex> lock(mutex);
+  idle[key].push_back(std::move(worker));
+}
+
+bool WorkerPool::disable(const std::string& key) {
+  std::lock_guard<std::mutex> lock(mutex);
+  return disabled.insert(key).second;
+}
+
+bool WorkerPool::isDisabled(const std::string& key) {
+  std::lock_guard<std::mutex> lock(mutex);
+  return disabled.count(key) != 0;
+}
+
+} // End namespace tester
@@ -0,0 +1,75 @@
+#include "toolchain/Pipes.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+
+namespace tester {
+
+bool openPipe(int ends[2]) {
+#if __linux__
+  return pipe2(ends, O_CLOEXEC) == 0;
+#else
+  // Without pipe2 a fork in another thread could slip in between, which only
+  // delays the end of the pipe until that child execs.
+  return pipe(ends) == 0 && fcntl(ends[0], F_SETFD, FD_CLOEXEC) == 0 &&
+         fcntl(ends[1], F_SETFD, FD_CLOEXEC) == 0;
+#endif
+}
+
+void closePipe(int fd) {
+  if (fd != -1)
+    close(fd);
+}
+
+bool readAll(int fd, std::string& contents, std::optional<size_t> lineLimit) {
+  char buffer[65536];
+  size_t lines = 0;
+  for (;;) {
+    ssize_t got = read(fd, buffer, sizeof(buffer));
+    if (got == 0)
+      return true;
+    if (got == -1 && errno != EINTR)
+      return false;
+    if (got > 0) {
+      contents.append(buffer, got);
+      lines += std::count(buffer, buffer + got, '\n');
+      if (lineLimit.has_value() && lines >= *lineLimit)
+        return true;
+    }
+  }
+}
+
+bool writeAll(int fd, std::string_view data) {
+  // A reader that stopped early would normally kill the writer with SIGPIPE.
+  // We are the writer here, so block it for this thread and discard it instead.
+  sigset_t pipeSet, oldSet;
+  sigemptyset(&pipeSet);
+  sigaddset(&pipeSet, SIGPIPE);
+  pthread_sigmask(SIG_BLOCK, &pipeSet, &oldSet);
+
+  bool wroteAll = true;
+  while (!data.empty()) {
+    ssize_t wrote = write(fd, data.data(), data.size());
+    if (wrote == -1 && errno == EINTR)
+      continue;
+    if (wrote == -1) {
+      bool brokenPipe = errno == EPIPE;
+      sigset_t pending;
+      int signal;
+      sigpending(&pending);
+      if (brokenPipe && sigismember(&pending, SIGPIPE))
+        sigwait(&pipeSet, &signal);
+      wroteAll = false;
+      break;
+    }
+    data.remove_prefix(wrote);
+  }
+  pthread_sigmask(SIG_SETMASK, &oldSet, nullptr);
+  return wroteAll;
+}
+
+} // End namespace tester
@@ -0,0 +1,44 @@
+#include "toolchain/StepCache.h"
+
+#include <unistd.h>
+
+namespace tester {
+
+StepCache::~StepCache() {
+  std::error_code ec;
+  if (!dir.empty())
+    fs::remove_all(dir, ec);
+}
+
+bool StepCache::restore(const std::string& exe, const std::string& key, const fs::path& output,
+                        StepTimings& timings) {
+  std::lock_guard<std::mutex> lock(mutex);
+  auto entry = entries.find({exe, key});
+  if (entry == entries.end())
+    return false;
+
+  // A copy rather than a link, the following steps may change the file.
+  std::error_code ec;
+  fs::copy_file(entry->second.copy, output, fs::copy_options::overwrite_existing, ec);
+  if (ec)
+    return false;
+  timings = entry->second.timings;
+  ++hits;
+  return true;
+}
+
+void StepCache::store(const std::string& exe, const std::string& key, const fs::path& output,
+                      const StepTimings& timings) {
+  std::lock_guard<std::mutex> lock(mutex);
+  std::error_code ec;
+  if (dir.empty()) {
+    dir = fs::temp_directory_path(ec) / ("tester_steps_" + std::to_string(getpid()));
+    fs::create_directories(dir, ec);
+  }
+
+  fs::path copy = dir / std::to_string(entries.size());
+  if (fs::copy_file(output, copy, fs::copy_options::overwrite_existing, ec))
+    entries[{exe, key}] = {copy, timings};
+}
+
+} // End namespace tester
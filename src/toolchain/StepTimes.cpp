@@ -0,0 +1,77 @@
+#include "toolchain/StepTimes.h"
+
+#include "json.hpp"
+
+#include <fstream>
+#include <stdexcept>
+
+using JSON = nlohmann::json;
+
+namespace tester {
+
+void StepTimes::record(const std::string& toolChain, const fs::path& test, size_t step,
+                       double seconds) {
+  std::lock_guard<std::mutex> lock(mutex);
+  std::vector<double>& steps = times[Key(toolChain, test.string())];
+  if (steps.size() <= step)
+    steps.resize(step + 1, -1);
+  steps[step] = seconds;
+}
+
+std::optional<double> StepTimes::find(const std::string& toolChain, const fs::path& test,
+                                      size_t step) const {
+  std::lock_guard<std::mutex> lock(mutex);
+  auto found = times.find(Key(toolChain, test.string()));
+  if (found == times.end() || found->second.size() <= step || found->second[step] < 0)
+    return std::nullopt;
+  return found->second[step];
+}
+
+void StepTimes::load(const fs::path& path) {
+  std::ifstream file(path);
+  if (!file.is_open())
+    return;
+
+  // {"<toolchain>": {"<test>": [seconds or null for each step]}}
+  JSON json;
+  try {
+    file >> json;
+  } catch (const JSON::exception& e) {
+    throw std::runtime_error("Timing history " + path.string() + " is malformed: " + e.what());
+  }
+  if (!json.is_object())
+    throw std::runtime_error("Timing history " + path.string() + " is not an object.");
+
+  std::lock_guard<std::mutex> lock(mutex);
+  for (auto toolChain = json.begin(); toolChain != json.end(); ++toolChain) {
+    if (!toolChain.value().is_object())
+      continue;
+    for (auto test = toolChain.value().begin(); test != toolChain.value().end(); ++test) {
+      std::vector<double>& steps = times[Key(toolChain.key(), test.key())];
+      if (!steps.empty() || !test.value().is_array())
+        continue;
+      for (const JSON& seconds : test.value())
+        steps.push_back(seconds.is_number() ? seconds.get<double>() : -1);
+    }
+  }
+}
+
+void StepTimes::save(const fs::path& path) const {
+  JSON json = JSON::object();
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto& [key, steps] : times) {
+      JSON stepsJson = JSON::array();
+      for (double seconds : steps)
+        stepsJson.push_back(seconds < 0 ? JSON() : JSON(seconds));
+      json[key.first][key.second] = stepsJson;
+    }
+  }
+
+  std::ofstream file(path);
+  file << json.dump(2);
+  if (!file)
+    throw std::runtime_error("Can't write the timing history to " + path.string() + ".");
+}
+
+} // End namespace tester
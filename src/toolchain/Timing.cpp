@@ -0,0 +1,58 @@
+#include "toolchain/Timing.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Scales the MAD so it estimates the standard deviation of normal data.
+constexpr double MAD_SCALE = 1.4826;
+
+// Samples more than this many scaled MADs from the median are outliers.
+constexpr double OUTLIER_CUTOFF = 3.0;
+
+double median(std::vector<double> values) {
+  if (values.empty())
+    return 0;
+  std::sort(values.begin(), values.end());
+  size_t mid = values.size() / 2;
+  return values.size() % 2 ? values[mid] : (values[mid - 1] + values[mid]) / 2;
+}
+
+double medianAbsoluteDeviation(const std::vector<double>& values, double center) {
+  std::vector<double> deviations;
+  for (double value : values)
+    deviations.push_back(std::fabs(value - center));
+  return median(deviations);
+}
+
+} // end anonymous namespace
+
+namespace tester {
+
+TimingStats summariseTimings(const std::vector<double>& samples, uint32_t warmups) {
+  TimingStats stats;
+  stats.samples = samples;
+  stats.warmups = warmups;
+  if (samples.empty())
+    return stats;
+
+  // Reject outliers relative to the full sample. With a MAD of zero most
+  // samples are identical and there is nothing meaningful to reject.
+  double center = median(samples);
+  double spread = MAD_SCALE * medianAbsoluteDeviation(samples, center);
+  std::vector<double> kept;
+  for (double sample : samples) {
+    if (spread > 0 && std::fabs(sample - center) > OUTLIER_CUTOFF * spread)
+      stats.outliers.push_back(sample);
+    else
+      kept.push_back(sample);
+  }
+
+  stats.median = median(kept);
+  stats.mad = medianAbsoluteDeviation(kept, stats.median);
+  stats.min = *std::min_element(kept.begin(), kept.end());
+  return stats;
+}
+
+} // End namespace tester
@@ -1,32 +1,216 @@
 #include "toolchain/ToolChain.h"
 
+#include "toolchain/Pipes.h"
 #include "util.h"
 
+#include <vector>
+
+#include <algorithm>
+#include <cerrno>
 #include <exception>
+#include <fstream>
+#include <future>
 #include <iostream>
+#include <iterator>
+
+#include <unistd.h>
+
+namespace {
+
+// Copy a step's stdout from a pipe into its output file, showing it to the
+// watcher on the way. Once the watcher has seen enough the step is stopped,
+// and the rest of what it wrote is still kept.
+void watchOutput(int fd, const fs::path& output, const tester::OutputWatcher& watcher,
+                 std::atomic_bool& stop) {
+  std::ofstream file(output, std::ios::binary | std::ios::trunc);
+  char buffer[65536];
+  ssize_t count;
+  while ((count = read(fd, buffer, sizeof(buffer))) != 0) {
+    if (count < 0) {
+      if (errno == EINTR)
+        continue;
+      break;
+    }
+    file.write(buffer, count);
+    if (!stop.load() && !watcher(std::string_view(buffer, count)))
+      stop.store(true);
+  }
+  tester::closePipe(fd);
+}
+
+} // End anonymous namespace
 
 namespace tester {
 
-ToolChain::ToolChain(const JSON& json, int64_t timeout) {
+ToolChain::ToolChain(const JSON& json, int64_t timeout) : timeout(timeout) {
+  // A toolchain with settings of its own is an object holding its steps.
+  const JSON* steps = &json;
+  if (json.is_object()) {
+    ensureContains(json, "steps");
+    steps = &json["steps"];
+    if (doesContain(json, "comparator"))
+      comparator = Comparator::create(json["comparator"]);
+  }
+
   // Make sure we've got an array of commands.
-  if (!json.is_array())
+  if (!steps->is_array())
     throw std::runtime_error("Not a toolchain array.");
 
   // Build our commands from each step.
-  for (const JSON& step : json)
+  for (const JSON& step : *steps)
     commands.emplace_back(step, timeout);
+
+  // A piped step needs a previous step whose result is on stdout.
+  for (size_t i = 0; i < commands.size(); ++i) {
+    if (!commands[i].isPipedFromPrevious())
+      continue;
+    if (i == 0)
+      throw std::runtime_error("The first step '" + commands[i].getName() +
+                               "' has no previous step to pipe from.");
+    if (commands[i - 1].hasOutputFile())
+      throw std::runtime_error("Step '" + commands[i].getName() + "' pipes from '" +
+                               commands[i - 1].getName() + "' which writes to an output file.");
+  }
+
+  // Only the first step sees every test's input up front, and its results
+  // have to be carried on to a following step.
+  for (size_t i = 0; i < commands.size(); ++i) {
+    if (commands[i].getBatchSize() != 0 && (i != 0 || commands.size() == 1))
+      throw std::runtime_error("Only the first of several steps can be batched, not '" +
+                               commands[i].getName() + "'.");
+  }
+
+  // Only the final step's output is compared.
+  for (size_t i = 0; i + 1 < commands.size(); ++i) {
+    if (commands[i].streamsVerdict())
+      throw std::runtime_error("Only the final step can stream its verdict, not '" +
+                               commands[i].getName() + "'.");
+  }
+}
+
+std::vector<std::string> ToolChain::getStepSignatures() const {
+  std::vector<std::string> signatures;
+  for (const Command& command : commands)
+    signatures.push_back(command.getSignature());
+  return signatures;
 }
 
-ExecutionOutput ToolChain::build(TestFile* test) const {
+bool ToolChain::isStepCacheable(size_t step) const {
+  return step + 1 < commands.size() && !commands[step + 1].isPipedFromPrevious() &&
+         commands[step].getBatchSize() == 0;
+}
+
+std::string ToolChain::getPrefixKey(size_t step, const TestFile* test) const {
+  return prefixKeys[step] + '\n' + test->getTestPath().string() + '\n' +
+         test->getInsPath().string();
+}
+
+bool ToolChain::isRelocatable() const {
+  return std::all_of(commands.begin(), commands.end(),
+                     [](const Command& command) { return command.isRelocatable(); });
+}
+
+void ToolChain::prepareBatch(const std::vector<TestFile*>& tests, const fs::path& scratchDir) {
+  batched.clear();
+  size_t batchSize = commands.front().getBatchSize();
+  if (batchSize == 0)
+    return;
+
+  // A memory limit is the test's own, so limited tests run on their own.
+  std::vector<TestFile*> batchable;
+  std::copy_if(tests.begin(), tests.end(), std::back_inserter(batchable),
+               [](const TestFile* test) { return !test->getMemoryLimit().has_value(); });
+
+  for (size_t first = 0; first < batchable.size(); first += batchSize) {
+    size_t last = std::min(batchable.size(), first + batchSize);
+    std::vector<ExecutionInput> eis;
+    for (size_t i = first; i < last; ++i) {
+      eis.emplace_back(batchable[i]->getTestPath(), batchable[i]->getInsPath(), testedExecutable,
+                       testedRuntime);
+      eis.back().setCpuAffinity(cpuAffinity);
+      eis.back().setScratchDir(scratchDir);
+      eis.back().setTimeout(batchable[i]->getTimeout());
+    }
+
+    // Inputs without a result, or the whole batch if it failed, are left to
+    // build() to run one at a time so failures stay with their test.
+    std::vector<ExecutionOutput> eos = commands.front().executeBatch(eis, first);
+    for (size_t i = 0; i < eos.size(); ++i) {
+      if (fs::exists(eos[i].getOutputFile()))
+        batched.emplace(batchable[first + i], eos[i]);
+    }
+  }
+}
+
+ExecutionOutput ToolChain::build(TestFile* test, const OutputWatcher& watcher,
+                                 const fs::path& scratchDir) const {
+  // The input context of a step reading `input`.
+  auto makeInput = [&](fs::path input) {
+    ExecutionInput ei(std::move(input), test->getInsPath(), testedExecutable, testedRuntime);
+    ei.setCpuAffinity(cpuAffinity);
+    ei.setScratchDir(scratchDir);
+    ei.setTimeout(test->getTimeout());
+    ei.setMemoryLimit(test->getMemoryLimit());
+    return ei;
+  };
+
   // The current output and input contexts.
-  ExecutionInput ei(test->getTestPath(), test->getInsPath(), testedExecutable, testedRuntime);
+  ExecutionInput ei = makeInput(test->getTestPath());
   ExecutionOutput eo;
+  test->setTimingStats(std::nullopt);
+  test->setPerfCounters(std::nullopt);
 
-  // Run the command, updating the contexts as we go.
-  for (const auto& cmd: commands) {
-    
-    eo = cmd.execute(ei);
+  // Resume after the longest prefix another toolchain already ran for this
+  // test, or else after a batched first step. The skipped steps are recorded
+  // with the times they took when the prefix ran.
+  size_t first = 0;
+  std::string exeKey = testedExecutable.string() + '\n' + testedRuntime.string();
+  StepCache::StepTimings timings;
+  for (size_t step = prefixKeys.size(); stepCache && first == 0 && step-- > 0;) {
+    const fs::path output = commands[step].getOutputPath(ei);
+    if (!prefixKeys[step].empty() &&
+        stepCache->restore(exeKey, getPrefixKey(step, test), output, timings)) {
+      ei = makeInput(output);
+      first = step + 1;
+    }
+  }
+  if (stepTimes && recordsStepTimes) {
+    for (const auto& [step, elapsed] : timings)
+      stepTimes->record(name, test->getTestPath(), step, elapsed);
+  }
+  auto prepared = batched.find(test);
+  if (first == 0 && prepared != batched.end()) {
+    ei = makeInput(prepared->second.getOutputFile());
+    first = 1;
+  }
+
+  // Run the commands, updating the contexts as we go. Steps piped from their
+  // predecessor run together with it.
+  while (first < commands.size()) {
+    size_t last = first;
+    while (last + 1 < commands.size() && commands[last + 1].isPipedFromPrevious())
+      ++last;
+    bool isFinal = last + 1 == commands.size();
+    if (isFinal)
+      ei.setMeasuresCounters(measureCounters);
+
+    // Give the steps a few times what the solution took, within the test's
+    // own limit, or else learn how long they take the solution.
+    if (stepTimes && adaptiveTimeout.isEnabled() && !recordsStepTimes) {
+      std::optional<double> solution = stepTimes->find(name, test->getTestPath(), last);
+      double limit = test->getTimeout().value_or(static_cast<double>(timeout));
+      if (solution.has_value())
+        ei.setTimeout(adaptiveTimeout.getLimit(*solution, limit));
+    }
+
+    eo = runSteps(first, last, ei, isFinal && watcher && streamsVerdict() ? &watcher : nullptr);
     int rv = eo.getReturnValue();
+
+    if (eo.getElapsedTime().has_value()) {
+      timings.emplace_back(last, *eo.getElapsedTime());
+      if (stepTimes && recordsStepTimes)
+        stepTimes->record(name, test->getTestPath(), last, *eo.getElapsedTime());
+    }
     
     // Terminate the toolchain prematurely if we encounter a non-zero exit status
     // or if the error stream has bytes. 
@@ -34,9 +218,17 @@ ExecutionOutput ToolChain::build(TestFile* test) const {
       eo.setIsErrorTest(true);
       return eo;
     }
-     
-    ei = ExecutionInput(eo.getOutputFile(), ei.getInputStreamFile(), ei.getTestedExecutable(),
-                        ei.getTestedRuntime());
+
+    // Time the final step over repeated runs if asked to.
+    if (isFinal && timingPolicy.isStatistical())
+      return repeatFinalStep(first, ei, eo, test);
+
+    // Keep the output for the other toolchains sharing this prefix.
+    if (stepCache && last < prefixKeys.size() && !prefixKeys[last].empty())
+      stepCache->store(exeKey, getPrefixKey(last, test), eo.getOutputFile(), timings);
+
+    ei = makeInput(eo.getOutputFile());
+    first = last + 1;
   }
 
   // store the elapsed time of the final step execution step into the testfile
@@ -44,7 +236,106 @@ ExecutionOutput ToolChain::build(TestFile* test) const {
   if (elapsedTime.has_value()) {
     test->setElapsedTime(elapsedTime.value());
   } 
+  test->setPerfCounters(eo.getPerfCounters());
+
+  return eo;
+}
+
+ExecutionOutput ToolChain::runSteps(size_t first, size_t last, const ExecutionInput& ei,
+                                    const OutputWatcher* watcher) const {
+  if (first == last && !watcher)
+    return commands[first].execute(ei);
+
+  // Start every step at once, each one's stdout connected straight to the next
+  // one's stdin. The data never passes through us or the disk.
+  std::vector<std::future<ExecutionOutput>> runs;
+  std::future<void> watching;
+  auto stop = std::make_shared<std::atomic_bool>(false);
+  int readEnd = -1;
+  for (size_t i = first; i <= last; ++i) {
+    // Piped steps see the pipe as their $INPUT too.
+    ExecutionInput stepEi = i == first ? ei
+      : ExecutionInput("/dev/stdin", ei.getInputStreamFile(), ei.getTestedExecutable(),
+                       ei.getTestedRuntime());
+    stepEi.setCpuAffinity(cpuAffinity);
+    stepEi.setScratchDir(ei.getScratchDir());
+    stepEi.setTimeout(ei.getTimeout());
+    stepEi.setMemoryLimit(ei.getMemoryLimit());
+    stepEi.setMeasuresCounters(i == last && ei.measuresCounters());
+
+    int ends[2] = {-1, -1};
+    if ((i != last || watcher) && !openPipe(ends)) {
+      // Closing the read end lets the steps already started finish.
+      closePipe(readEnd);
+      for (auto& run : runs)
+        run.wait();
+      throw std::runtime_error("Could not create a pipe after step '" + commands[i].getName() +
+                               "'.");
+    }
+
+    stepEi.setPipes(readEnd, ends[1]);
+    if (i == last && watcher) {
+      stepEi.setStopFlag(stop);
+      watching = std::async(std::launch::async, watchOutput, ends[0],
+                            commands[i].getOutputPath(stepEi), std::cref(*watcher),
+                            std::ref(*stop));
+    }
+    runs.push_back(std::async(std::launch::async, [this, i, stepEi]() {
+      return commands[i].execute(stepEi);
+    }));
+    readEnd = ends[0];
+  }
+
+  // Wait on every step before reporting so none are left running. The
+  // earliest step to fail is the one reported.
+  std::vector<ExecutionOutput> outputs;
+  std::exception_ptr failure;
+  for (auto& run : runs) {
+    try {
+      outputs.push_back(run.get());
+    } catch (...) {
+      if (!failure)
+        failure = std::current_exception();
+      outputs.emplace_back();
+    }
+  }
+  if (watching.valid())
+    watching.wait();
+  if (failure)
+    std::rethrow_exception(failure);
+
+  // As with steps run one by one, the first non-zero exit status ends the toolchain.
+  for (const ExecutionOutput& out : outputs) {
+    if (out.getReturnValue() != 0)
+      return out;
+  }
+  return outputs.back();
+}
+
+ExecutionOutput ToolChain::repeatFinalStep(size_t first, const ExecutionInput& ei,
+                                           ExecutionOutput eo, TestFile* test) const {
+  // The run that already happened counts as the first warm-up, or as the first
+  // measured run when no warm-ups are wanted.
+  std::vector<double> samples;
+  if (timingPolicy.warmups == 0)
+    samples.push_back(eo.getElapsedTime().value_or(0));
+
+  for (uint32_t run = 1; run < timingPolicy.warmups + timingPolicy.repetitions; ++run) {
+    eo = runSteps(first, commands.size() - 1, ei);
+
+    // A run that fails stops the repetitions, the toolchain reports it as usual.
+    if (eo.getReturnValue() != 0) {
+      eo.setIsErrorTest(true);
+      return eo;
+    }
+    if (run >= timingPolicy.warmups)
+      samples.push_back(eo.getElapsedTime().value_or(0));
+  }
 
+  TimingStats stats = summariseTimings(samples, timingPolicy.warmups);
+  test->setElapsedTime(stats.median);
+  test->setTimingStats(std::move(stats));
+  test->setPerfCounters(eo.getPerfCounters());
   return eo;
 }
 
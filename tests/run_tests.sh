@@ -10,6 +10,7 @@ TEST_CONFIGS=(
   "$CWD/ConfigGrade.json"
   "$CWD/ConfigExpectedFail.json"
   "$CWD/ConfigRuntime.json"
+  "$CWD/ConfigFeatures.json"
 )
 
 # Grading variables
@@ -92,6 +93,13 @@ if [ $? -ne 0 ]; then
   exit 1
 fi
 
+#========= RUN Step Feature Tests =========#
+$PROJECT_BASE/bin/tester ${TEST_CONFIGS[4]} --timeout 10
+if [ $? -ne 0 ]; then
+  echo "Tester failed test for config: ${TEST_CONFIGS[4]}"
+  exit 1
+fi
+
 #========= RUN Expected Failure Tests =========#
 $PROJECT_BASE/bin/tester ${TEST_CONFIGS[2]} --timeout 10
 if [ $? -ne 1 ]; then
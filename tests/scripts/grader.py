@@ -7,7 +7,7 @@ import argparse
 import json
 import pandas as pd
 from fractions import Fraction
-from typing import List
+from typing import List, Optional
 
 MIN_COLUMNS = 6
 DEFENSE_POINT_SCORE = 2
@@ -33,10 +33,16 @@ class Attack:
         self.attacker = attack_result["attacker"]
         self.test_count = attack_result["testCount"]
         self.pass_count = attack_result["passCount"]
-        self.timings = attack_result["timings"]
-
-    def get_pass_rate(self) -> Fraction:
-        return Fraction(self.pass_count, self.test_count)
+        self.invalid_count = attack_result.get("invalidCount", 0)
+        self.timings = [ timing for timing in attack_result["timings"] if not timing.get("invalid") ]
+
+    def get_pass_rate(self) -> Optional[Fraction]:
+        # Tests that fail the solution are invalid and count as 0 tests. An attacker
+        # left with no valid tests has no pass rate, its cell stays empty.
+        valid_count = self.test_count - self.invalid_count
+        if valid_count == 0:
+            return None
+        return Fraction(self.pass_count, valid_count)
     
     def __str__(self):
         return f"<Attack attacker={self.attacker}\>"
@@ -162,7 +168,8 @@ def get_timing_tests(toolchain) -> List[str]:
         for attack_obj in defense_obj["defenderResults"]:
             if attack_obj["attacker"] == TIMED_PACKAGE:
                 for timing in attack_obj["timings"]:
-                    timed_tests.append(timing['test']) 
+                    if not timing.get("invalid"):
+                        timed_tests.append(timing['test']) 
                 return timed_tests
     return timed_tests
 
@@ -175,13 +182,13 @@ def create_toolchain_summary_table(toolchains) -> pd.DataFrame:
     # init the summary table as a copy of the first tc
     tcs_table = toolchains[0]
 
-    # add each toolchain on top of the other. This is the first half of the average
-    # computation where all numerical value of same coordinates are added
-    for tc in toolchains[1:]: 
-        tcs_table.iloc[1:,1:] += tc.iloc[1:,1:]
-
-    # normalize each value to compute the average 
-    tcs_table.iloc[1:, 1:] = tcs_table.iloc[1:, 1:] / len(toolchains)
+    # average each cell over the toolchains that have a value for it. A pass rate
+    # is None where the attacker had no valid tests, and stays None only if it is
+    # None for every toolchain.
+    for i in range(1, tcs_table.shape[0]):
+        for j in range(1, tcs_table.shape[1]):
+            values = [ tc.iat[i, j] for tc in toolchains if tc.iat[i, j] is not None ]
+            tcs_table.iat[i, j] = sum(values) / len(values) if values else None
     tcs_table.to_csv(OUTPUT_CSV, index=False, header=False, mode="a")
     print(f"============ TOOLCHAIN SUMMARY TABLE ============\n", tcs_table) 
 
@@ -212,7 +219,7 @@ def create_toolchain_results_table(name, results) -> pd.DataFrame:
 
     # calculate each offensive score
     for j in range(1, n_defenders + 1):
-        points_df.at[1, j] = (1-df.iloc[1:, j]).sum()
+        points_df.at[1, j] = sum(1 - rate for rate in df.iloc[1:, j] if rate is not None)
 
     # give a coherence score
     for j in range(1, n_defenders + 1):
@@ -299,7 +306,8 @@ def create_final_summary_table(toolchain_summary, timing_summary = None) -> pd.D
     # the label corresponding to the supplied TA_PACKAGE variable.
     index = get_attacking_package_names().index(TA_PACKAGE) + 1 # offset from first column of labels by 1
     ta_pass_rate_col = toolchain_summary.iloc[1:n_attackers+1, index]
-    fst.iloc[0, 1:] = (ta_pass_rate_col.T * TA_TEST_WEIGHT).fillna(0).round(5)
+    fst.iloc[0, 1:] = [ 0 if rate is None else round(float(rate * TA_TEST_WEIGHT), 5)
+                        for rate in ta_pass_rate_col ]
 
     # Get competiative testing scores
     comp_row = toolchain_summary.iloc[n_defenders+4, 1:]
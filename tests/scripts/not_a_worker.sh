@@ -0,0 +1,12 @@
+#!/bin/bash
+
+# script: not_a_worker.sh
+# description: used by ConfigFeatures.json as a persistent step that doesn't
+# speak the protocol. Asked to be a worker, it reads stdin and never answers,
+# otherwise it runs its arguments as a command.
+
+if [ "$1" == "--persistent_worker" ]; then
+  cat > /dev/null
+  exit 0
+fi
+exec "$@"
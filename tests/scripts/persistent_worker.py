@@ -0,0 +1,31 @@
+#!/usr/bin/env python3
+"""
+Persistent worker used by ConfigFeatures.json. Each request's arguments are run
+as a command and what it left behind is sent back. Started as a plain process,
+as it is for tests with a MEMORY: limit, it runs its own arguments instead.
+"""
+
+import json
+import os
+import subprocess
+import sys
+
+def serve():
+    for line in sys.stdin:
+        request = json.loads(line)
+        stdin = subprocess.DEVNULL
+        if request["inputStream"]:
+            stdin = open(request["inputStream"], "rb")
+        done = subprocess.run(request["arguments"], stdin=stdin, capture_output=True)
+        response = {
+            "exitCode": done.returncode,
+            "stdout": done.stdout.decode(errors="replace"),
+            "stderr": done.stderr.decode(errors="replace")
+        }
+        print(json.dumps(response), flush=True)
+
+if __name__ == "__main__":
+    if sys.argv[1:] == ["--persistent_worker"]:
+        serve()
+    else:
+        os.execv(sys.argv[1], sys.argv[1:])
@@ -0,0 +1,12 @@
+#include <stdio.h>
+
+int main() {
+
+  for (int i = 0; i < 100; i++)
+    printf("%d\n", i == 42 ? -1 : i);
+
+  return 0;
+}
+
+// The digest is of the numbers 0 to 99, the reference shows where they differ.
+//CHECK_HASH: 6d506216aa5bad159f167e2535293b4e5ec8e1073b64449d30b66b460ebf6da0 290 ./004_check_hash.out
@@ -0,0 +1,6 @@
+int main() {
+  return 0;
+}
+
+// A time limit must be a number of seconds.
+// TIMEOUT: soon
@@ -0,0 +1,6 @@
+int main() {
+  return 0;
+}
+
+// A memory limit takes a K, M or G suffix, not a unit name.
+// MEMORY: 512MB
@@ -0,0 +1,13 @@
+#include <stdio.h>
+
+int main() {
+
+  double third = 1.0 / 3.0;
+  printf("%.12f %.12f\n", third, 1000000 * third);
+
+  return 0;
+}
+
+// Only six digits are checked, the rest are within the tolerance.
+//COMPARATOR:numeric:1e-6
+//CHECK:0.333333 333333.333333
@@ -0,0 +1,15 @@
+#include <stdio.h>
+
+int main() {
+
+  for (int i = 3; i > 0; i--) {
+    printf("line %d\n", i);
+  }
+
+  return 0;
+}
+
+//COMPARATOR:unordered-lines
+//CHECK:line 1
+//CHECK:line 2
+//CHECK:line 3
@@ -0,0 +1,15 @@
+#include <stdio.h>
+
+int main() {
+
+  // Heavier than most tests, so it has a budget of its own instead of --timeout.
+  unsigned long sum = 0;
+  for (unsigned long i = 0; i < 100000000; i++)
+    sum += i % 7;
+  printf("%lu", sum);
+
+  return 0;
+}
+
+//TIMEOUT: 30
+//CHECK:299999995
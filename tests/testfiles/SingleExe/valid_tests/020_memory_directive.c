@@ -0,0 +1,15 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+int main() {
+
+  // More than the test may use, so the allocation fails.
+  char* block = malloc((size_t)3 << 30);
+  printf("%s", block ? "allocated" : "refused");
+  free(block);
+
+  return 0;
+}
+
+//MEMORY: 1G
+//CHECK:refused
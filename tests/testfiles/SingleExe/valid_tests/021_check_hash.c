@@ -0,0 +1,12 @@
+#include <stdio.h>
+
+int main() {
+
+  // Several megabytes of output, kept in the tree as only a digest.
+  for (int i = 0; i < 500000; i++)
+    printf("%d %d\n", i, i * 7 % 1000);
+
+  return 0;
+}
+
+//CHECK_HASH: b835a49ef2ce8eb0ff9b479e8bc214a19101e6a25fc14f4c8d763fa33d92e1fc 5333890
@@ -0,0 +1,16 @@
+#include <stdio.h>
+
+int main() {
+
+  char line[64];
+  while (fgets(line, sizeof(line), stdin))
+    printf("%s", line);
+  printf("\nTIMEOUT: none");
+
+  return 0;
+}
+
+// Directive names inside an INPUT or CHECK are just text.
+// INPUT:MEMORY: 12 blocks
+// CHECK:MEMORY: 12 blocks
+// CHECK:TIMEOUT: none
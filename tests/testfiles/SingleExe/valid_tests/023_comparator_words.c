@@ -0,0 +1,12 @@
+#include <stdio.h>
+
+int main() {
+
+  printf("1.0\nCOMPARATOR: numeric");
+
+  return 0;
+}
+
+// This test has no COMPARATOR: the output is checked byte for byte, with no CHECK_HASH: either.
+// CHECK:1.0
+// CHECK:COMPARATOR: numeric